@@ -0,0 +1,589 @@
+// Análise dos registros de atraso por pacote (atrasos.bin, gerado com --delayLog=true).
+//
+// Os registros (fluxo, tamanho, envio, entrega) são lidos por mmap e transpostos para um layout
+// em colunas (structure of arrays), de modo que cada estatística percorra memória contígua. Os
+// laços internos usam AVX2 quando a CPU oferece e caem para a versão escalar caso contrário
+// (ou com --scalar, para comparação). Por janela de tempo de entrega são calculados vazão,
+// atraso médio/mínimo/máximo, percentis e jitter (média de |Δatraso| entre pacotes consecutivos
+// do mesmo fluxo); o mesmo resumo é impresso por fluxo.
+//
+// Uso: delay-analyzer [--window=segundos] [--flows=atrasos-fluxos.csv] [--csv=janelas.csv]
+//                     [--scalar] atrasos.bin
+//
+// Com --flows, as janelas consideram apenas os fluxos de dados (sem ACKs do TCP e pedidos HTTP)
+// e o resumo por fluxo mostra a 5-tupla.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DELAY_ANALYZER_X86
+#endif
+
+// Mesmo layout do RegistroAtraso do script_Equipe_2.cc
+struct RegistroAtraso
+{
+    uint32_t flow;
+    uint32_t size;
+    double txTime;
+    double rxTime;
+};
+
+// Registros em colunas, na ordem de entrega
+struct Colunas
+{
+    std::vector<uint32_t> flow;
+    std::vector<uint32_t> size;
+    std::vector<double> rxTime;
+    std::vector<double> delay; // Segundos
+};
+
+// Estatísticas de um intervalo contíguo de registros
+struct Parcial
+{
+    uint64_t bytes = 0;
+    double sum = 0;
+    double sumSquares = 0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+};
+
+// --- Núcleos escalares ---
+
+void
+AtrasosEscalar(const double* tx, const double* rx, double* delay, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; i++)
+    {
+        delay[i] = rx[i] - tx[i];
+    }
+}
+
+Parcial
+ParcialEscalar(const double* delay, const uint32_t* size, std::size_t n)
+{
+    Parcial result;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        result.bytes += size[i];
+        result.sum += delay[i];
+        result.sumSquares += delay[i] * delay[i];
+        result.min = std::min(result.min, delay[i]);
+        result.max = std::max(result.max, delay[i]);
+    }
+    return result;
+}
+
+// Soma de |delay[i] - delay[i - 1]| para i em [1, n)
+double
+VariacaoEscalar(const double* delay, std::size_t n)
+{
+    double sum = 0;
+    for (std::size_t i = 1; i < n; i++)
+    {
+        sum += std::fabs(delay[i] - delay[i - 1]);
+    }
+    return sum;
+}
+
+// --- Núcleos AVX2 (4 doubles por instrução) ---
+
+#ifdef DELAY_ANALYZER_X86
+__attribute__((target("avx2"))) void
+AtrasosAvx2(const double* tx, const double* rx, double* delay, std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256d r = _mm256_loadu_pd(rx + i);
+        __m256d t = _mm256_loadu_pd(tx + i);
+        _mm256_storeu_pd(delay + i, _mm256_sub_pd(r, t));
+    }
+    AtrasosEscalar(tx + i, rx + i, delay + i, n - i);
+}
+
+__attribute__((target("avx2"))) double
+SomaHorizontal(__m256d value)
+{
+    __m128d low = _mm256_castpd256_pd128(value);
+    __m128d high = _mm256_extractf128_pd(value, 1);
+    low = _mm_add_pd(low, high);
+    return _mm_cvtsd_f64(_mm_add_sd(low, _mm_unpackhi_pd(low, low)));
+}
+
+__attribute__((target("avx2"))) Parcial
+ParcialAvx2(const double* delay, const uint32_t* size, std::size_t n)
+{
+    __m256d sum = _mm256_setzero_pd();
+    __m256d sumSquares = _mm256_setzero_pd();
+    __m256d min = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    __m256d max = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+    __m256i bytes = _mm256_setzero_si256();
+
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256d d = _mm256_loadu_pd(delay + i);
+        sum = _mm256_add_pd(sum, d);
+        sumSquares = _mm256_add_pd(sumSquares, _mm256_mul_pd(d, d));
+        min = _mm256_min_pd(min, d);
+        max = _mm256_max_pd(max, d);
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(size + i));
+        bytes = _mm256_add_epi64(bytes, _mm256_cvtepu32_epi64(s));
+    }
+
+    Parcial result;
+    result.sum = SomaHorizontal(sum);
+    result.sumSquares = SomaHorizontal(sumSquares);
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, min);
+    result.min = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+    _mm256_store_pd(lanes, max);
+    result.max = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    alignas(32) uint64_t byteLanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(byteLanes), bytes);
+    result.bytes = byteLanes[0] + byteLanes[1] + byteLanes[2] + byteLanes[3];
+
+    Parcial tail = ParcialEscalar(delay + i, size + i, n - i);
+    result.bytes += tail.bytes;
+    result.sum += tail.sum;
+    result.sumSquares += tail.sumSquares;
+    result.min = std::min(result.min, tail.min);
+    result.max = std::max(result.max, tail.max);
+    return result;
+}
+
+__attribute__((target("avx2"))) double
+VariacaoAvx2(const double* delay, std::size_t n)
+{
+    if (n < 2)
+    {
+        return 0;
+    }
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    __m256d sum = _mm256_setzero_pd();
+    std::size_t i = 1;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256d current = _mm256_loadu_pd(delay + i);
+        __m256d previous = _mm256_loadu_pd(delay + i - 1);
+        sum = _mm256_add_pd(sum, _mm256_andnot_pd(signMask, _mm256_sub_pd(current, previous)));
+    }
+    double result = SomaHorizontal(sum);
+    for (; i < n; i++)
+    {
+        result += std::fabs(delay[i] - delay[i - 1]);
+    }
+    return result;
+}
+#endif
+
+// Núcleos escolhidos em tempo de execução
+struct Nucleos
+{
+    void (*atrasos)(const double*, const double*, double*, std::size_t) = AtrasosEscalar;
+    Parcial (*parcial)(const double*, const uint32_t*, std::size_t) = ParcialEscalar;
+    double (*variacao)(const double*, std::size_t) = VariacaoEscalar;
+    const char* name = "escalar";
+};
+
+Nucleos
+EscolherNucleos(bool forceScalar)
+{
+    Nucleos kernels;
+#ifdef DELAY_ANALYZER_X86
+    if (!forceScalar && __builtin_cpu_supports("avx2"))
+    {
+        kernels.atrasos = AtrasosAvx2;
+        kernels.parcial = ParcialAvx2;
+        kernels.variacao = VariacaoAvx2;
+        kernels.name = "AVX2";
+    }
+#endif
+    return kernels;
+}
+
+// Lê atrasos.bin por mmap e transpõe os registros para colunas
+bool
+CarregarRegistros(const std::string& path, const Nucleos& kernels, Colunas& columns)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0 || info.st_size < 16)
+    {
+        std::cerr << "Não foi possível abrir " << path << "\n";
+        return false;
+    }
+    std::size_t length = info.st_size;
+    void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        std::cerr << "Falha no mmap de " << path << "\n";
+        return false;
+    }
+    madvise(mapping, length, MADV_SEQUENTIAL);
+    const uint8_t* data = static_cast<const uint8_t*>(mapping);
+
+    uint32_t recordSize;
+    std::memcpy(&recordSize, data + 8, 4);
+    if (std::memcmp(data, "ATRASOS1", 8) != 0 || recordSize != sizeof(RegistroAtraso))
+    {
+        std::cerr << path << " não é um registro de atrasos reconhecido\n";
+        munmap(mapping, length);
+        return false;
+    }
+
+    std::size_t n = (length - 16) / sizeof(RegistroAtraso);
+    const uint8_t* records = data + 16;
+    columns.flow.resize(n);
+    columns.size.resize(n);
+    columns.rxTime.resize(n);
+    columns.delay.resize(n);
+    std::vector<double> txTime(n);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        RegistroAtraso record;
+        std::memcpy(&record, records + i * sizeof(RegistroAtraso), sizeof(RegistroAtraso));
+        columns.flow[i] = record.flow;
+        columns.size[i] = record.size;
+        txTime[i] = record.txTime;
+        columns.rxTime[i] = record.rxTime;
+    }
+    munmap(mapping, length);
+
+    kernels.atrasos(txTime.data(), columns.rxTime.data(), columns.delay.data(), n);
+    return true;
+}
+
+// Percentis por seleção parcial sobre uma cópia (a ordem original precisa ser preservada). Os
+// percentis pedidos em ordem crescente reaproveitam a partição anterior: cada seleção só percorre
+// o trecho acima da posição já encontrada.
+std::vector<double>
+Percentis(std::vector<double>& scratch, const std::vector<double>& percentiles)
+{
+    std::vector<double> result(percentiles.size(), 0);
+    auto begin = scratch.begin();
+    for (std::size_t i = 0; i < percentiles.size() && !scratch.empty(); i++)
+    {
+        std::size_t rank = std::max(1.0, std::ceil(percentiles[i] * scratch.size()));
+        auto position = scratch.begin() + (std::min(scratch.size(), rank) - 1);
+        if (position >= begin)
+        {
+            std::nth_element(begin, position, scratch.end());
+            begin = position;
+        }
+        result[i] = *position;
+    }
+    return result;
+}
+
+// Reordena as colunas por fluxo (ordenação por contagem, estável, preservando a ordem de entrega
+// dentro de cada fluxo). offsets[f]..offsets[f + 1] delimita o fluxo f.
+Colunas
+AgruparPorFluxo(const Colunas& columns, std::vector<std::size_t>& offsets)
+{
+    uint32_t flows = 0;
+    for (uint32_t flow : columns.flow)
+    {
+        flows = std::max(flows, flow + 1);
+    }
+    offsets.assign(flows + 1, 0);
+    for (uint32_t flow : columns.flow)
+    {
+        offsets[flow + 1]++;
+    }
+    for (uint32_t f = 0; f < flows; f++)
+    {
+        offsets[f + 1] += offsets[f];
+    }
+
+    Colunas grouped;
+    std::size_t n = columns.flow.size();
+    grouped.flow.resize(n);
+    grouped.size.resize(n);
+    grouped.rxTime.resize(n);
+    grouped.delay.resize(n);
+    std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        std::size_t j = next[columns.flow[i]]++;
+        grouped.flow[j] = columns.flow[i];
+        grouped.size[j] = columns.size[i];
+        grouped.rxTime[j] = columns.rxTime[i];
+        grouped.delay[j] = columns.delay[i];
+    }
+    return grouped;
+}
+
+// Tabela atrasos-fluxos.csv: rótulo e indicação de fluxo de dados por índice
+bool
+LerTabelaFluxos(const std::string& path, std::vector<std::string>& labels, std::vector<bool>& data)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << "Não foi possível abrir " << path << "\n";
+        return false;
+    }
+    std::string line;
+    std::getline(file, line); // Cabeçalho
+    while (std::getline(file, line))
+    {
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, ','))
+        {
+            fields.push_back(field);
+        }
+        if (fields.size() < 7)
+        {
+            continue;
+        }
+        uint32_t flow = std::stoul(fields[0]);
+        if (labels.size() <= flow)
+        {
+            labels.resize(flow + 1);
+            data.resize(flow + 1, true);
+        }
+        labels[flow] = (fields[1] == "6" ? "TCP " : fields[1] == "17" ? "UDP " : fields[1] + " ") +
+                       fields[2] + ":" + fields[3] + " -> " + fields[4] + ":" + fields[5];
+        data[flow] = fields[6] == "1";
+    }
+    return true;
+}
+
+int
+main(int argc, char* argv[])
+{
+    double window = 1.0;
+    bool forceScalar = false;
+    std::string flowsPath;
+    std::string csvPath;
+    std::string input;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument.rfind("--window=", 0) == 0)
+        {
+            window = std::atof(argument.c_str() + 9);
+        }
+        else if (argument.rfind("--flows=", 0) == 0)
+        {
+            flowsPath = argument.substr(8);
+        }
+        else if (argument.rfind("--csv=", 0) == 0)
+        {
+            csvPath = argument.substr(6);
+        }
+        else if (argument == "--scalar")
+        {
+            forceScalar = true;
+        }
+        else
+        {
+            input = argument;
+        }
+    }
+    if (input.empty() || window <= 0)
+    {
+        std::cerr << "Uso: " << argv[0]
+                  << " [--window=segundos] [--flows=atrasos-fluxos.csv] [--csv=janelas.csv] "
+                     "[--scalar] atrasos.bin\n";
+        return 1;
+    }
+
+    Nucleos kernels = EscolherNucleos(forceScalar);
+    auto start = std::chrono::steady_clock::now();
+
+    Colunas columns;
+    if (!CarregarRegistros(input, kernels, columns))
+    {
+        return 1;
+    }
+    std::size_t n = columns.flow.size();
+    auto loaded = std::chrono::steady_clock::now();
+
+    std::vector<std::string> labels;
+    std::vector<bool> dataFlow;
+    if (!flowsPath.empty() && !LerTabelaFluxos(flowsPath, labels, dataFlow))
+    {
+        return 1;
+    }
+
+    std::vector<std::size_t> offsets;
+    Colunas grouped = AgruparPorFluxo(columns, offsets);
+    uint32_t flows = offsets.size() - 1;
+    auto included = [&](uint32_t flow) { return flow >= dataFlow.size() || dataFlow[flow]; };
+
+    double lastTime = n ? columns.rxTime[n - 1] : 0;
+    std::size_t windows = std::size_t(lastTime / window) + 1;
+
+    // Janelas: estatísticas somadas por fluxo, cada fluxo percorrido em blocos contíguos por janela
+    std::vector<Parcial> windowStats(windows);
+    std::vector<uint64_t> windowRecords(windows, 0);
+    std::vector<double> windowVariation(windows, 0);
+    std::vector<uint64_t> windowPairs(windows, 0);
+    std::vector<std::vector<double>> windowDelays(windows);
+
+    struct ResumoFluxo
+    {
+        Parcial stats;
+        uint64_t records;
+        double variation;
+        double p99;
+        double duration;
+    };
+    std::vector<ResumoFluxo> flowSummary(flows);
+
+    std::vector<double> scratch;
+    for (uint32_t f = 0; f < flows; f++)
+    {
+        std::size_t begin = offsets[f];
+        std::size_t end = offsets[f + 1];
+        const double* rx = grouped.rxTime.data();
+        const double* delay = grouped.delay.data();
+        const uint32_t* size = grouped.size.data();
+
+        ResumoFluxo& summary = flowSummary[f];
+        summary.records = end - begin;
+        summary.stats = kernels.parcial(delay + begin, size + begin, end - begin);
+        summary.variation = kernels.variacao(delay + begin, end - begin);
+        scratch.assign(delay + begin, delay + end);
+        summary.p99 = Percentis(scratch, {0.99})[0];
+        summary.duration = end > begin ? rx[end - 1] - rx[begin] : 0;
+
+        if (!included(f))
+        {
+            continue;
+        }
+        std::size_t i = begin;
+        while (i < end)
+        {
+            // O fim da janela usa o mesmo cálculo do índice: comparar com (w + 1) * window
+            // falharia quando a divisão arredonda para baixo um instante exato de fronteira
+            std::size_t w = std::min(std::size_t(rx[i] / window), windows - 1);
+            std::size_t limit = i + 1;
+            while (limit < end && std::min(std::size_t(rx[limit] / window), windows - 1) == w)
+            {
+                limit++;
+            }
+            Parcial part = kernels.parcial(delay + i, size + i, limit - i);
+            Parcial& total = windowStats[w];
+            total.bytes += part.bytes;
+            total.sum += part.sum;
+            total.sumSquares += part.sumSquares;
+            total.min = std::min(total.min, part.min);
+            total.max = std::max(total.max, part.max);
+            windowRecords[w] += limit - i;
+            // A variação entre janelas vizinhas conta o par que cruza a fronteira na janela nova
+            std::size_t first = i > begin ? i - 1 : i;
+            windowVariation[w] += kernels.variacao(delay + first, limit - first);
+            windowPairs[w] += limit - first - 1;
+            windowDelays[w].insert(windowDelays[w].end(), delay + i, delay + limit);
+            i = limit;
+        }
+    }
+    auto finished = std::chrono::steady_clock::now();
+
+    std::cout << std::fixed << std::setprecision(6);
+    std::cout << "Janela (s)\tRegistros\tVazão (Mbps)\tAtraso médio (ms)\tMín (ms)\tMáx (ms)\t"
+                 "p50 (ms)\tp95 (ms)\tp99 (ms)\tJitter (ms)\n";
+    std::FILE* csv = csvPath.empty() ? nullptr : std::fopen(csvPath.c_str(), "w");
+    if (!csvPath.empty() && !csv)
+    {
+        std::cerr << "Não foi possível criar " << csvPath << "\n";
+        return 1;
+    }
+    if (csv)
+    {
+        std::fprintf(csv, "start,records,mbps,meanMs,minMs,maxMs,p50Ms,p95Ms,p99Ms,jitterMs\n");
+    }
+    for (std::size_t w = 0; w < windows; w++)
+    {
+        if (windowRecords[w] == 0)
+        {
+            continue;
+        }
+        const Parcial& stats = windowStats[w];
+        double mbps = stats.bytes * 8.0 / window / 1e6;
+        double mean = stats.sum / windowRecords[w] * 1000;
+        std::vector<double> quantiles = Percentis(windowDelays[w], {0.50, 0.95, 0.99});
+        double p50 = quantiles[0] * 1000;
+        double p95 = quantiles[1] * 1000;
+        double p99 = quantiles[2] * 1000;
+        double jitter = windowPairs[w] ? windowVariation[w] / windowPairs[w] * 1000 : 0;
+        std::cout << w * window << "\t\t" << windowRecords[w] << "\t\t" << mbps << "\t" << mean
+                  << "\t\t" << stats.min * 1000 << "\t" << stats.max * 1000 << "\t" << p50 << "\t"
+                  << p95 << "\t" << p99 << "\t" << jitter << "\n";
+        if (csv)
+        {
+            std::fprintf(csv,
+                         "%.6f,%llu,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f\n",
+                         w * window,
+                         static_cast<unsigned long long>(windowRecords[w]),
+                         mbps,
+                         mean,
+                         stats.min * 1000,
+                         stats.max * 1000,
+                         p50,
+                         p95,
+                         p99,
+                         jitter);
+        }
+    }
+    if (csv)
+    {
+        std::fclose(csv);
+    }
+
+    std::cout << "\nFluxo\tRegistros\tVazão (Mbps)\tAtraso médio (ms)\tDesvio (ms)\tp99 (ms)\t"
+                 "Jitter (ms)\n";
+    for (uint32_t f = 0; f < flows; f++)
+    {
+        const ResumoFluxo& summary = flowSummary[f];
+        if (summary.records == 0)
+        {
+            continue;
+        }
+        double mean = summary.stats.sum / summary.records;
+        double variance =
+            std::max(0.0, summary.stats.sumSquares / summary.records - mean * mean);
+        std::cout << f << "\t" << summary.records << "\t\t"
+                  << (summary.duration > 0 ? summary.stats.bytes * 8.0 / summary.duration / 1e6 : 0)
+                  << "\t" << mean * 1000 << "\t\t" << std::sqrt(variance) * 1000 << "\t"
+                  << summary.p99 * 1000 << "\t"
+                  << (summary.records > 1 ? summary.variation / (summary.records - 1) * 1000 : 0);
+        if (f < labels.size() && !labels[f].empty())
+        {
+            std::cout << "\t" << labels[f] << (included(f) ? "" : " (retorno)");
+        }
+        std::cout << "\n";
+    }
+
+    double loadSeconds = std::chrono::duration<double>(loaded - start).count();
+    double analysisSeconds = std::chrono::duration<double>(finished - loaded).count();
+    double totalSeconds = loadSeconds + analysisSeconds;
+    std::cerr << "Núcleos " << kernels.name << ": " << n << " registros, leitura " << loadSeconds
+              << " s, análise " << analysisSeconds << " s, "
+              << (totalSeconds > 0 ? n / totalSeconds : 0) << " registros/s\n";
+    return 0;
+}
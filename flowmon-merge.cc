@@ -0,0 +1,622 @@
+// Agregador de arquivos XML do FlowMonitor (SerializeToXmlFile) de várias replicações.
+//
+// Os arquivos são lidos em fluxo, tag a tag, sem montar a árvore do documento: a memória usada
+// depende apenas do número de fluxos de cada arquivo, não do seu tamanho. Cada thread processa
+// arquivos inteiros e mantém um agregado parcial; os parciais são combinados no final.
+//
+// Os fluxos de replicações diferentes são casados pela 5-tupla sem a porta efêmera:
+// (protocolo, origem, destino, porta do serviço), onde a porta do serviço é a menor das duas.
+//
+// Uso: flowmon-merge [--threads=N] [--histograms=arquivo.csv] arquivo1.xml [arquivo2.xml ...]
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+// Estatística incremental (Welford) com combinação de parciais
+struct Acumulador
+{
+    uint64_t n = 0;
+    double mean = 0;
+    double m2 = 0;
+    double min = 0;
+    double max = 0;
+
+    void Add(double value)
+    {
+        n++;
+        double delta = value - mean;
+        mean += delta / n;
+        m2 += delta * (value - mean);
+        min = n == 1 ? value : std::min(min, value);
+        max = n == 1 ? value : std::max(max, value);
+    }
+
+    void Merge(const Acumulador& other)
+    {
+        if (other.n == 0)
+        {
+            return;
+        }
+        if (n == 0)
+        {
+            *this = other;
+            return;
+        }
+        uint64_t total = n + other.n;
+        double delta = other.mean - mean;
+        mean += delta * other.n / total;
+        m2 += other.m2 + delta * delta * n * other.n / total;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+        n = total;
+    }
+
+    double StdDev() const
+    {
+        return n > 1 ? std::sqrt(m2 / (n - 1)) : 0;
+    }
+
+    // Meia largura do intervalo de confiança de 95% (aproximação normal)
+    double Ci95() const
+    {
+        return n > 1 ? 1.96 * StdDev() / std::sqrt(double(n)) : 0;
+    }
+};
+
+// Histograma agregado: início do bin -> (largura, contagem)
+using Histograma = std::map<double, std::pair<double, uint64_t>>;
+
+void
+MesclarHistograma(Histograma& target, const Histograma& source)
+{
+    for (const auto& bin : source)
+    {
+        auto& merged = target[bin.first];
+        merged.first = bin.second.first;
+        merged.second += bin.second.second;
+    }
+}
+
+// Contadores de um fluxo em um único arquivo
+struct FluxoArquivo
+{
+    double timeFirstTx = 0;
+    double timeFirstRx = 0;
+    double timeLastRx = 0;
+    double delaySum = 0;
+    double jitterSum = 0;
+    uint64_t txBytes = 0;
+    uint64_t rxBytes = 0;
+    uint64_t txPackets = 0;
+    uint64_t rxPackets = 0;
+    uint64_t lostPackets = 0;
+    uint64_t timesForwarded = 0;
+    std::map<uint32_t, uint64_t> packetsDropped;
+    Histograma delayHistogram;
+    Histograma jitterHistogram;
+    Histograma packetSizeHistogram;
+};
+
+// Fluxo agregado entre replicações
+struct FluxoAgregado
+{
+    uint64_t txBytes = 0;
+    uint64_t rxBytes = 0;
+    uint64_t txPackets = 0;
+    uint64_t rxPackets = 0;
+    uint64_t lostPackets = 0;
+    uint64_t timesForwarded = 0;
+    double delaySum = 0;
+    double jitterSum = 0;
+    Acumulador goodputMbps; // Uma amostra por replicação
+    Acumulador delayMs;
+    Acumulador lossPercent;
+    std::map<uint32_t, uint64_t> packetsDropped;
+    Histograma delayHistogram;
+    Histograma jitterHistogram;
+    Histograma packetSizeHistogram;
+
+    void Add(const FluxoArquivo& flow)
+    {
+        txBytes += flow.txBytes;
+        rxBytes += flow.rxBytes;
+        txPackets += flow.txPackets;
+        rxPackets += flow.rxPackets;
+        lostPackets += flow.lostPackets;
+        timesForwarded += flow.timesForwarded;
+        delaySum += flow.delaySum;
+        jitterSum += flow.jitterSum;
+
+        double duration = flow.timeLastRx - flow.timeFirstRx;
+        goodputMbps.Add(duration > 0 ? flow.rxBytes * 8.0 / duration / 1e6 : 0);
+        if (flow.rxPackets > 0)
+        {
+            delayMs.Add(flow.delaySum / flow.rxPackets * 1000);
+        }
+        if (flow.rxPackets + flow.lostPackets > 0)
+        {
+            lossPercent.Add(100.0 * flow.lostPackets / (flow.rxPackets + flow.lostPackets));
+        }
+        for (const auto& drop : flow.packetsDropped)
+        {
+            packetsDropped[drop.first] += drop.second;
+        }
+        MesclarHistograma(delayHistogram, flow.delayHistogram);
+        MesclarHistograma(jitterHistogram, flow.jitterHistogram);
+        MesclarHistograma(packetSizeHistogram, flow.packetSizeHistogram);
+    }
+
+    void Merge(const FluxoAgregado& other)
+    {
+        txBytes += other.txBytes;
+        rxBytes += other.rxBytes;
+        txPackets += other.txPackets;
+        rxPackets += other.rxPackets;
+        lostPackets += other.lostPackets;
+        timesForwarded += other.timesForwarded;
+        delaySum += other.delaySum;
+        jitterSum += other.jitterSum;
+        goodputMbps.Merge(other.goodputMbps);
+        delayMs.Merge(other.delayMs);
+        lossPercent.Merge(other.lossPercent);
+        for (const auto& drop : other.packetsDropped)
+        {
+            packetsDropped[drop.first] += drop.second;
+        }
+        MesclarHistograma(delayHistogram, other.delayHistogram);
+        MesclarHistograma(jitterHistogram, other.jitterHistogram);
+        MesclarHistograma(packetSizeHistogram, other.packetSizeHistogram);
+    }
+};
+
+// (protocolo, origem, destino, porta do serviço)
+using ChaveFluxo = std::tuple<uint32_t, std::string, std::string, uint32_t>;
+
+struct Agregado
+{
+    uint64_t files = 0;
+    uint64_t bytes = 0;
+    std::map<ChaveFluxo, FluxoAgregado> flows;
+
+    void Merge(const Agregado& other)
+    {
+        files += other.files;
+        bytes += other.bytes;
+        for (const auto& flow : other.flows)
+        {
+            flows[flow.first].Merge(flow.second);
+        }
+    }
+};
+
+// Tag XML lida pelo leitor em fluxo
+struct Tag
+{
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> attributes;
+    bool closing = false; // </nome>
+
+    const std::string* Get(const char* attribute) const
+    {
+        for (const auto& item : attributes)
+        {
+            if (item.first == attribute)
+            {
+                return &item.second;
+            }
+        }
+        return nullptr;
+    }
+};
+
+// Converte um tempo do ns-3 ("+2.5e+09ns", "+1.2s", ...) para segundos
+double
+ParseTempo(const std::string* text)
+{
+    if (!text)
+    {
+        return 0;
+    }
+    char* end = nullptr;
+    double value = std::strtod(text->c_str(), &end);
+    std::string unit(end);
+    if (unit == "ns")
+    {
+        return value * 1e-9;
+    }
+    if (unit == "us")
+    {
+        return value * 1e-6;
+    }
+    if (unit == "ms")
+    {
+        return value * 1e-3;
+    }
+    if (unit == "ps")
+    {
+        return value * 1e-12;
+    }
+    if (unit == "fs")
+    {
+        return value * 1e-15;
+    }
+    if (unit == "min")
+    {
+        return value * 60;
+    }
+    if (unit == "h")
+    {
+        return value * 3600;
+    }
+    return value;
+}
+
+// Separa o conteúdo entre '<' e '>' em nome e atributos
+bool
+ParseTag(const std::string& text, Tag& tag)
+{
+    tag.attributes.clear();
+    tag.closing = !text.empty() && text[0] == '/';
+    std::size_t position = tag.closing ? 1 : 0;
+    std::size_t nameEnd = text.find_first_of(" \t\r\n/", position);
+    tag.name = text.substr(position, nameEnd - position);
+
+    while (nameEnd != std::string::npos)
+    {
+        std::size_t nameStart = text.find_first_not_of(" \t\r\n/", nameEnd);
+        if (nameStart == std::string::npos)
+        {
+            break;
+        }
+        std::size_t equals = text.find('=', nameStart);
+        if (equals == std::string::npos)
+        {
+            break;
+        }
+        std::size_t quote = text.find_first_of("\"'", equals);
+        if (quote == std::string::npos)
+        {
+            return false;
+        }
+        std::size_t close = text.find(text[quote], quote + 1);
+        if (close == std::string::npos)
+        {
+            return false;
+        }
+        std::string name = text.substr(nameStart, equals - nameStart);
+        name.erase(name.find_last_not_of(" \t\r\n") + 1);
+        tag.attributes.emplace_back(name, text.substr(quote + 1, close - quote - 1));
+        nameEnd = close + 1;
+    }
+    return true;
+}
+
+std::string
+ParseTexto(const std::string* text)
+{
+    return text ? *text : std::string();
+}
+
+uint64_t
+ParseInteiro(const std::string* text)
+{
+    return text ? std::strtoull(text->c_str(), nullptr, 10) : 0;
+}
+
+double
+ParseReal(const std::string* text)
+{
+    return text ? std::strtod(text->c_str(), nullptr) : 0;
+}
+
+// Lê um arquivo do FlowMonitor em blocos e agrega seus fluxos. As estatísticas vêm antes do
+// classificador no XML, então os fluxos do arquivo ficam guardados por ID até o final.
+bool
+ProcessarArquivo(const std::string& path, Agregado& aggregate)
+{
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        std::cerr << "Não foi possível abrir " << path << "\n";
+        return false;
+    }
+
+    std::map<uint32_t, FluxoArquivo> flows;
+    std::map<uint32_t, ChaveFluxo> keys;
+
+    // Estado do leitor: seção atual e histograma sendo lido
+    enum Secao
+    {
+        OUTRA,
+        FLOW_STATS,
+        IPV4_CLASSIFIER,
+    } section = OUTRA;
+    FluxoArquivo* current = nullptr;
+    Histograma* histogram = nullptr;
+
+    std::vector<char> buffer(1 << 20);
+    std::string text;
+    bool insideTag = false;
+    Tag tag;
+    uint64_t bytes = 0;
+
+    std::size_t read;
+    while ((read = std::fread(buffer.data(), 1, buffer.size(), file)) > 0)
+    {
+        bytes += read;
+        const char* data = buffer.data();
+        const char* end = data + read;
+        while (data < end)
+        {
+            if (!insideTag)
+            {
+                const char* open = static_cast<const char*>(std::memchr(data, '<', end - data));
+                if (!open)
+                {
+                    break;
+                }
+                insideTag = true;
+                text.clear();
+                data = open + 1;
+                continue;
+            }
+
+            const char* close = static_cast<const char*>(std::memchr(data, '>', end - data));
+            if (!close)
+            {
+                text.append(data, end);
+                break;
+            }
+            text.append(data, close);
+            data = close + 1;
+            insideTag = false;
+
+            if (text.empty() || text[0] == '?' || text[0] == '!' || !ParseTag(text, tag))
+            {
+                continue;
+            }
+
+            if (tag.closing)
+            {
+                if (tag.name == "FlowStats" || tag.name == "Ipv4FlowClassifier")
+                {
+                    section = OUTRA;
+                }
+                else if (tag.name == "Flow")
+                {
+                    current = nullptr;
+                }
+                histogram = nullptr;
+                continue;
+            }
+
+            if (tag.name == "FlowStats" && section == OUTRA && !tag.Get("flowId"))
+            {
+                section = FLOW_STATS;
+            }
+            else if (tag.name == "Ipv4FlowClassifier")
+            {
+                section = IPV4_CLASSIFIER;
+            }
+            else if (tag.name == "Flow" && section == FLOW_STATS)
+            {
+                FluxoArquivo& flow = flows[ParseInteiro(tag.Get("flowId"))];
+                flow.timeFirstTx = ParseTempo(tag.Get("timeFirstTxPacket"));
+                flow.timeFirstRx = ParseTempo(tag.Get("timeFirstRxPacket"));
+                flow.timeLastRx = ParseTempo(tag.Get("timeLastRxPacket"));
+                flow.delaySum = ParseTempo(tag.Get("delaySum"));
+                flow.jitterSum = ParseTempo(tag.Get("jitterSum"));
+                flow.txBytes = ParseInteiro(tag.Get("txBytes"));
+                flow.rxBytes = ParseInteiro(tag.Get("rxBytes"));
+                flow.txPackets = ParseInteiro(tag.Get("txPackets"));
+                flow.rxPackets = ParseInteiro(tag.Get("rxPackets"));
+                flow.lostPackets = ParseInteiro(tag.Get("lostPackets"));
+                flow.timesForwarded = ParseInteiro(tag.Get("timesForwarded"));
+                current = &flow;
+            }
+            else if (current && tag.name == "delayHistogram")
+            {
+                histogram = &current->delayHistogram;
+            }
+            else if (current && tag.name == "jitterHistogram")
+            {
+                histogram = &current->jitterHistogram;
+            }
+            else if (current && tag.name == "packetSizeHistogram")
+            {
+                histogram = &current->packetSizeHistogram;
+            }
+            else if (current && tag.name == "flowInterruptionsHistogram")
+            {
+                histogram = nullptr;
+            }
+            else if (current && histogram && tag.name == "bin")
+            {
+                auto& bin = (*histogram)[ParseReal(tag.Get("start"))];
+                bin.first = ParseReal(tag.Get("width"));
+                bin.second += ParseInteiro(tag.Get("count"));
+            }
+            else if (current && tag.name == "packetsDropped")
+            {
+                current->packetsDropped[ParseInteiro(tag.Get("reasonCode"))] +=
+                    ParseInteiro(tag.Get("number"));
+            }
+            else if (tag.name == "Flow" && section == IPV4_CLASSIFIER)
+            {
+                uint32_t sourcePort = ParseInteiro(tag.Get("sourcePort"));
+                uint32_t destinationPort = ParseInteiro(tag.Get("destinationPort"));
+                keys[ParseInteiro(tag.Get("flowId"))] =
+                    ChaveFluxo(ParseInteiro(tag.Get("protocol")),
+                               ParseTexto(tag.Get("sourceAddress")),
+                               ParseTexto(tag.Get("destinationAddress")),
+                               std::min(sourcePort, destinationPort));
+            }
+        }
+    }
+    std::fclose(file);
+
+    for (const auto& flow : flows)
+    {
+        auto key = keys.find(flow.first);
+        if (key == keys.end())
+        {
+            continue; // Fluxo IPv6 ou sem classificação
+        }
+        aggregate.flows[key->second].Add(flow.second);
+    }
+    aggregate.files++;
+    aggregate.bytes += bytes;
+    return true;
+}
+
+// Percentil (ms) de um histograma de atraso em segundos
+double
+Percentil(const Histograma& histogram, double percentile)
+{
+    uint64_t total = 0;
+    for (const auto& bin : histogram)
+    {
+        total += bin.second.second;
+    }
+    uint64_t target = std::ceil(total * percentile);
+    uint64_t accumulated = 0;
+    for (const auto& bin : histogram)
+    {
+        accumulated += bin.second.second;
+        if (accumulated >= target && total > 0)
+        {
+            return (bin.first + bin.second.first / 2) * 1000;
+        }
+    }
+    return 0;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string histogramsPath;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument.rfind("--threads=", 0) == 0)
+        {
+            threads = std::max(1, std::atoi(argument.c_str() + 10));
+        }
+        else if (argument.rfind("--histograms=", 0) == 0)
+        {
+            histogramsPath = argument.substr(13);
+        }
+        else
+        {
+            files.push_back(argument);
+        }
+    }
+
+    if (files.empty())
+    {
+        std::cerr << "Uso: " << argv[0]
+                  << " [--threads=N] [--histograms=arquivo.csv] arquivo1.xml [arquivo2.xml ...]\n";
+        return 1;
+    }
+
+    // Cada thread pega o próximo arquivo da lista e agrega em seu parcial
+    threads = std::min<uint32_t>(threads, files.size());
+    std::vector<Agregado> partials(threads);
+    std::atomic<std::size_t> next(0);
+    std::atomic<uint32_t> failures(0);
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&, t]() {
+            for (std::size_t i = next++; i < files.size(); i = next++)
+            {
+                if (!ProcessarArquivo(files[i], partials[t]))
+                {
+                    failures++;
+                }
+            }
+        });
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    Agregado aggregate;
+    for (const auto& partial : partials)
+    {
+        aggregate.Merge(partial);
+    }
+
+    std::cout << std::fixed << std::setprecision(6);
+    std::cout << "Arquivos: " << aggregate.files << " (" << aggregate.bytes / 1e6
+              << " MB), falhas: " << failures << ", fluxos: " << aggregate.flows.size() << "\n";
+    std::cout << "Protocolo\tOrigem\t\tDestino\t\tPorta\tReplicações\tGoodput médio (Mbps)"
+                 "\tIC95\tAtraso médio (ms)\tp50 (ms)\tp99 (ms)\tPerda (%)\tJitter médio (ms)\n";
+    for (const auto& flow : aggregate.flows)
+    {
+        const FluxoAgregado& stats = flow.second;
+        double loss = stats.rxPackets + stats.lostPackets
+                          ? 100.0 * stats.lostPackets / (stats.rxPackets + stats.lostPackets)
+                          : 0;
+        double jitter = stats.rxPackets > 1 ? stats.jitterSum / (stats.rxPackets - 1) * 1000 : 0;
+        std::cout << std::get<0>(flow.first) << "\t\t" << std::get<1>(flow.first) << "\t"
+                  << std::get<2>(flow.first) << "\t" << std::get<3>(flow.first) << "\t"
+                  << stats.goodputMbps.n << "\t\t" << stats.goodputMbps.mean << "\t\t"
+                  << stats.goodputMbps.Ci95() << "\t" << stats.delayMs.mean << "\t\t"
+                  << Percentil(stats.delayHistogram, 0.50) << "\t"
+                  << Percentil(stats.delayHistogram, 0.99) << "\t" << loss << "\t" << jitter
+                  << "\n";
+    }
+
+    if (!histogramsPath.empty())
+    {
+        std::FILE* output = std::fopen(histogramsPath.c_str(), "w");
+        if (!output)
+        {
+            std::cerr << "Não foi possível criar " << histogramsPath << "\n";
+            return 1;
+        }
+        std::fprintf(output, "protocol,source,destination,port,histogram,start,width,count\n");
+        for (const auto& flow : aggregate.flows)
+        {
+            const std::pair<const char*, const Histograma*> histograms[] = {
+                {"delay", &flow.second.delayHistogram},
+                {"jitter", &flow.second.jitterHistogram},
+                {"packetSize", &flow.second.packetSizeHistogram}};
+            for (const auto& histogram : histograms)
+            {
+                for (const auto& bin : *histogram.second)
+                {
+                    std::fprintf(output,
+                                 "%u,%s,%s,%u,%s,%.9g,%.9g,%llu\n",
+                                 std::get<0>(flow.first),
+                                 std::get<1>(flow.first).c_str(),
+                                 std::get<2>(flow.first).c_str(),
+                                 std::get<3>(flow.first),
+                                 histogram.first,
+                                 bin.first,
+                                 bin.second.first,
+                                 static_cast<unsigned long long>(bin.second.second));
+                }
+            }
+        }
+        std::fclose(output);
+    }
+
+    return failures ? 2 : 0;
+}
@@ -0,0 +1,627 @@
+// Analisador de pcaps gerados pelos cenários (EnablePcapAll no P2P e EnablePcap no AP).
+//
+// O arquivo é mapeado em memória (mmap) e percorrido registro a registro, decodificando
+// PPP / 802.11 / radiotap / Ethernet até IPv4, UDP e TCP. Para cada fluxo (5-tupla) calcula:
+// bytes e pacotes IP (a mesma contagem do FlowMonitor), série temporal de vazão, retransmissões
+// TCP (segmentos abaixo da maior sequência já vista), retransmissões MAC (bit Retry do 802.11)
+// e o jitter de chegada (suavização da RFC 3550 sobre a variação do intervalo entre pacotes).
+//
+// Quadros 802.11 com o bit Retry cujo Identification já foi visto no fluxo são retransmissões
+// MAC do mesmo pacote: contam apenas como retry, sem entrar em pacotes, bytes, série ou TCP.
+//
+// Com dois arquivos (ex.: pcap do AP e pcap do servidor no P2P), os pacotes são casados pela
+// 5-tupla e pelo campo Identification do IPv4, o que dá o atraso e a perda entre os dois pontos
+// de captura. O sentido é decidido por fluxo: o ponto em que a maioria dos pacotes casados
+// aparece primeiro é o montante, então fluxos de subida e de descida saem com atraso positivo.
+//
+// Uso: pcap-analyzer [--interval=segundos] [--series=serie.csv] captura1.pcap [captura2.pcap]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+// Tipos de enlace do cabeçalho global do pcap
+const uint32_t DLT_EN10MB = 1;
+const uint32_t DLT_PPP = 9;
+const uint32_t DLT_IEEE802_11 = 105;
+const uint32_t DLT_IEEE802_11_RADIO = 127;
+
+struct ChaveFluxo
+{
+    uint32_t source;
+    uint32_t destination;
+    uint16_t sourcePort;
+    uint16_t destinationPort;
+    uint8_t protocol;
+
+    bool operator==(const ChaveFluxo& other) const
+    {
+        return source == other.source && destination == other.destination &&
+               sourcePort == other.sourcePort && destinationPort == other.destinationPort &&
+               protocol == other.protocol;
+    }
+
+    bool operator<(const ChaveFluxo& other) const
+    {
+        return std::tie(protocol, source, destination, sourcePort, destinationPort) <
+               std::tie(other.protocol,
+                        other.source,
+                        other.destination,
+                        other.sourcePort,
+                        other.destinationPort);
+    }
+};
+
+struct HashFluxo
+{
+    std::size_t operator()(const ChaveFluxo& key) const
+    {
+        uint64_t hash = (uint64_t(key.source) << 32) ^ key.destination;
+        hash ^= (uint64_t(key.sourcePort) << 24) ^ (uint64_t(key.destinationPort) << 8) ^
+                key.protocol;
+        hash *= 0x9e3779b97f4a7c15ULL;
+        return hash ^ (hash >> 29);
+    }
+};
+
+// Pacote IPv4 decodificado
+struct Pacote
+{
+    double time;
+    ChaveFluxo key;
+    uint16_t ipId;
+    uint16_t ipLength;
+    uint32_t payload;
+    uint32_t tcpSeq;
+    bool macRetry;
+};
+
+// Métricas de um fluxo em um ponto de captura
+struct FluxoPcap
+{
+    uint64_t packets = 0;
+    uint64_t bytes = 0;
+    uint64_t payloadBytes = 0;
+    double firstTime = 0;
+    double lastTime = 0;
+    uint64_t tcpRetransmissions = 0;
+    uint64_t macRetries = 0;
+    bool tcpSeen = false;
+    uint32_t tcpHighestSeq = 0;
+    double lastInterArrival = -1;
+    double interArrivalSum = 0;
+    double jitter = 0;
+    std::vector<uint64_t> series; // Bytes por intervalo, a partir do instante 0
+
+    // Último instante de cada Identification em cada arquivo, para reconhecer retries MAC
+    std::unordered_map<uint16_t, double> seenIds[2];
+
+    // Casamento entre pontos de captura
+    std::unordered_map<uint16_t, double> pending; // Identification -> instante no 1º arquivo
+    std::vector<double> offsets;                  // Instante no 2º menos no 1º, por pacote casado
+    uint64_t onlySecond = 0;                      // Pacotes vistos apenas no 2º arquivo
+    uint64_t matched = 0;
+    uint64_t unmatched = 0;
+    double delaySum = 0;
+    std::map<uint32_t, uint64_t> delayHistogram; // Bins de 0,1 ms
+};
+
+using TabelaFluxos = std::unordered_map<ChaveFluxo, FluxoPcap, HashFluxo>;
+
+// Janela em que um quadro com Retry e Identification repetido é tratado como retransmissão MAC
+// (o Identification dá a volta em 65536 pacotes)
+const double retryWindow = 1.0;
+
+// Registra o Identification do pacote no arquivo e diz se o quadro é retry MAC de um pacote já
+// contado
+bool
+RetryRepetido(FluxoPcap& flow, int file, const Pacote& packet)
+{
+    auto seen = flow.seenIds[file].find(packet.ipId);
+    bool repeated = packet.macRetry && seen != flow.seenIds[file].end() &&
+                    packet.time - seen->second < retryWindow;
+    flow.seenIds[file][packet.ipId] = packet.time;
+    return repeated;
+}
+
+uint16_t
+Ler16(const uint8_t* data)
+{
+    return uint16_t(data[0]) << 8 | data[1];
+}
+
+uint32_t
+Ler32(const uint8_t* data)
+{
+    return uint32_t(data[0]) << 24 | uint32_t(data[1]) << 16 | uint32_t(data[2]) << 8 | data[3];
+}
+
+// Decodifica IPv4 + UDP/TCP a partir do início do cabeçalho IP
+bool
+DecodificarIpv4(const uint8_t* data, uint32_t length, Pacote& packet)
+{
+    if (length < 20 || (data[0] >> 4) != 4)
+    {
+        return false;
+    }
+    uint32_t headerLength = (data[0] & 0x0f) * 4;
+    packet.ipLength = Ler16(data + 2);
+    packet.ipId = Ler16(data + 4);
+    packet.key.protocol = data[9];
+    packet.key.source = Ler32(data + 12);
+    packet.key.destination = Ler32(data + 16);
+    packet.key.sourcePort = 0;
+    packet.key.destinationPort = 0;
+    packet.payload = 0;
+    packet.tcpSeq = 0;
+
+    const uint8_t* transport = data + headerLength;
+    uint32_t available = length > headerLength ? length - headerLength : 0;
+    uint32_t ipPayload = packet.ipLength > headerLength ? packet.ipLength - headerLength : 0;
+    if (packet.key.protocol == 17 && available >= 8)
+    {
+        packet.key.sourcePort = Ler16(transport);
+        packet.key.destinationPort = Ler16(transport + 2);
+        packet.payload = ipPayload > 8 ? ipPayload - 8 : 0;
+    }
+    else if (packet.key.protocol == 6 && available >= 20)
+    {
+        packet.key.sourcePort = Ler16(transport);
+        packet.key.destinationPort = Ler16(transport + 2);
+        packet.tcpSeq = Ler32(transport + 4);
+        uint32_t tcpHeader = (transport[12] >> 4) * 4;
+        packet.payload = ipPayload > tcpHeader ? ipPayload - tcpHeader : 0;
+    }
+    return true;
+}
+
+// Decodifica um quadro 802.11 de dados até o IPv4 (cabeçalho MAC, QoS/HT e LLC/SNAP)
+bool
+Decodificar80211(const uint8_t* data, uint32_t length, Pacote& packet)
+{
+    if (length < 24)
+    {
+        return false;
+    }
+    uint8_t type = (data[0] >> 2) & 0x3;
+    uint8_t subtype = (data[0] >> 4) & 0xf;
+    uint8_t flags = data[1];
+    if (type != 2 || (subtype & 0x4) || (flags & 0x40))
+    {
+        return false; // Não é dado, é quadro nulo ou está cifrado
+    }
+
+    uint32_t header = 24;
+    if ((flags & 0x03) == 0x03)
+    {
+        header += 6; // Quarto endereço (WDS)
+    }
+    if (subtype & 0x8)
+    {
+        header += 2; // QoS Control
+        if (flags & 0x80)
+        {
+            header += 4; // HT Control
+        }
+    }
+    if (length < header + 8)
+    {
+        return false;
+    }
+
+    const uint8_t* llc = data + header;
+    if (llc[0] != 0xaa || llc[1] != 0xaa || llc[2] != 0x03 || Ler16(llc + 6) != 0x0800)
+    {
+        return false;
+    }
+    packet.macRetry = flags & 0x08;
+    return DecodificarIpv4(llc + 8, length - header - 8, packet);
+}
+
+bool
+DecodificarQuadro(uint32_t linkType, const uint8_t* data, uint32_t length, Pacote& packet)
+{
+    packet.macRetry = false;
+    switch (linkType)
+    {
+    case DLT_PPP:
+        if (length >= 4 && data[0] == 0xff && data[1] == 0x03)
+        {
+            data += 2; // Endereço e controle HDLC
+            length -= 2;
+        }
+        return length >= 2 && Ler16(data) == 0x0021 && DecodificarIpv4(data + 2, length - 2, packet);
+    case DLT_EN10MB:
+        return length >= 14 && Ler16(data + 12) == 0x0800 &&
+               DecodificarIpv4(data + 14, length - 14, packet);
+    case DLT_IEEE802_11:
+        return Decodificar80211(data, length, packet);
+    case DLT_IEEE802_11_RADIO: {
+        if (length < 4)
+        {
+            return false;
+        }
+        uint32_t radiotap = data[2] | uint32_t(data[3]) << 8; // it_len, little-endian
+        return length > radiotap && Decodificar80211(data + radiotap, length - radiotap, packet);
+    }
+    default:
+        return false;
+    }
+}
+
+// Arquivo pcap mapeado em memória
+class ArquivoPcap
+{
+  public:
+    explicit ArquivoPcap(const std::string& path)
+    {
+        m_fd = open(path.c_str(), O_RDONLY);
+        struct stat info;
+        if (m_fd < 0 || fstat(m_fd, &info) != 0 || info.st_size < 24)
+        {
+            std::cerr << "Não foi possível abrir " << path << "\n";
+            return;
+        }
+        m_size = info.st_size;
+        void* mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            std::cerr << "Falha no mmap de " << path << "\n";
+            m_size = 0;
+            return;
+        }
+        madvise(mapping, m_size, MADV_SEQUENTIAL);
+        m_data = static_cast<const uint8_t*>(mapping);
+
+        uint32_t magic;
+        std::memcpy(&magic, m_data, 4);
+        if (magic == 0xa1b2c3d4 || magic == 0xa1b23c4d)
+        {
+            m_swapped = false;
+        }
+        else if (magic == 0xd4c3b2a1 || magic == 0x4d3cb2a1)
+        {
+            m_swapped = true;
+        }
+        else
+        {
+            std::cerr << path << " não é um pcap\n";
+            return;
+        }
+        m_nanoseconds = magic == 0xa1b23c4d || magic == 0x4d3cb2a1;
+        m_linkType = Campo(20);
+        m_valid = true;
+    }
+
+    ~ArquivoPcap()
+    {
+        if (m_data)
+        {
+            munmap(const_cast<uint8_t*>(m_data), m_size);
+        }
+        if (m_fd >= 0)
+        {
+            close(m_fd);
+        }
+    }
+
+    bool Valido() const
+    {
+        return m_valid;
+    }
+
+    std::size_t Tamanho() const
+    {
+        return m_size;
+    }
+
+    // Percorre todos os registros, entregando os pacotes IPv4 decodificados
+    template <typename Funcao>
+    uint64_t Percorrer(Funcao callback) const
+    {
+        uint64_t records = 0;
+        std::size_t offset = 24;
+        Pacote packet;
+        while (offset + 16 <= m_size)
+        {
+            uint32_t seconds = Campo(offset);
+            uint32_t fraction = Campo(offset + 4);
+            uint32_t captured = Campo(offset + 8);
+            offset += 16;
+            if (offset + captured > m_size)
+            {
+                break; // Registro truncado no final do arquivo
+            }
+            records++;
+            if (DecodificarQuadro(m_linkType, m_data + offset, captured, packet))
+            {
+                packet.time = seconds + fraction * (m_nanoseconds ? 1e-9 : 1e-6);
+                callback(packet);
+            }
+            offset += captured;
+        }
+        return records;
+    }
+
+  private:
+    uint32_t Campo(std::size_t offset) const
+    {
+        uint32_t value;
+        std::memcpy(&value, m_data + offset, 4);
+        return m_swapped ? __builtin_bswap32(value) : value;
+    }
+
+    int m_fd = -1;
+    const uint8_t* m_data = nullptr;
+    std::size_t m_size = 0;
+    bool m_swapped = false;
+    bool m_nanoseconds = false;
+    bool m_valid = false;
+    uint32_t m_linkType = 0;
+};
+
+std::string
+Endereco(uint32_t address, uint16_t port)
+{
+    std::ostringstream text;
+    text << (address >> 24) << "." << ((address >> 16) & 0xff) << "." << ((address >> 8) & 0xff)
+         << "." << (address & 0xff) << ":" << port;
+    return text.str();
+}
+
+double
+PercentilAtraso(const std::map<uint32_t, uint64_t>& histogram, uint64_t total, double percentile)
+{
+    uint64_t target = std::ceil(total * percentile);
+    uint64_t accumulated = 0;
+    for (const auto& bin : histogram)
+    {
+        accumulated += bin.second;
+        if (accumulated >= target)
+        {
+            return (bin.first + 0.5) * 0.1;
+        }
+    }
+    return 0;
+}
+
+int
+main(int argc, char* argv[])
+{
+    double interval = 1.0;
+    std::string seriesPath;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument.rfind("--interval=", 0) == 0)
+        {
+            interval = std::atof(argument.c_str() + 11);
+        }
+        else if (argument.rfind("--series=", 0) == 0)
+        {
+            seriesPath = argument.substr(9);
+        }
+        else
+        {
+            files.push_back(argument);
+        }
+    }
+    if (files.empty() || files.size() > 2 || interval <= 0)
+    {
+        std::cerr << "Uso: " << argv[0]
+                  << " [--interval=segundos] [--series=serie.csv] captura1.pcap [captura2.pcap]\n";
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t totalBytes = 0;
+    uint64_t totalRecords = 0;
+
+    ArquivoPcap upstream(files[0]);
+    if (!upstream.Valido())
+    {
+        return 1;
+    }
+    bool pair = files.size() == 2;
+
+    TabelaFluxos flows;
+    totalBytes += upstream.Tamanho();
+    totalRecords += upstream.Percorrer([&](const Pacote& packet) {
+        FluxoPcap& flow = flows[packet.key];
+        if (RetryRepetido(flow, 0, packet))
+        {
+            flow.macRetries++;
+            return;
+        }
+        if (flow.packets == 0)
+        {
+            flow.firstTime = packet.time;
+        }
+        else
+        {
+            double interArrival = packet.time - flow.lastTime;
+            flow.interArrivalSum += interArrival;
+            if (flow.lastInterArrival >= 0)
+            {
+                flow.jitter += (std::fabs(interArrival - flow.lastInterArrival) - flow.jitter) / 16;
+            }
+            flow.lastInterArrival = interArrival;
+        }
+        flow.lastTime = packet.time;
+        flow.packets++;
+        flow.bytes += packet.ipLength;
+        flow.payloadBytes += packet.payload;
+        flow.macRetries += packet.macRetry;
+
+        std::size_t bucket = packet.time / interval;
+        if (flow.series.size() <= bucket)
+        {
+            flow.series.resize(bucket + 1, 0);
+        }
+        flow.series[bucket] += packet.ipLength;
+
+        if (packet.key.protocol == 6 && packet.payload > 0)
+        {
+            uint32_t end = packet.tcpSeq + packet.payload;
+            if (!flow.tcpSeen)
+            {
+                flow.tcpSeen = true;
+                flow.tcpHighestSeq = end;
+            }
+            else if (int32_t(packet.tcpSeq - flow.tcpHighestSeq) < 0)
+            {
+                flow.tcpRetransmissions++;
+            }
+            else
+            {
+                flow.tcpHighestSeq = end;
+            }
+        }
+
+        if (pair)
+        {
+            flow.pending[packet.ipId] = packet.time;
+        }
+    });
+
+    if (pair)
+    {
+        ArquivoPcap downstream(files[1]);
+        if (!downstream.Valido())
+        {
+            return 1;
+        }
+        totalBytes += downstream.Tamanho();
+        totalRecords += downstream.Percorrer([&](const Pacote& packet) {
+            auto flow = flows.find(packet.key);
+            if (flow == flows.end() || RetryRepetido(flow->second, 1, packet))
+            {
+                return;
+            }
+            auto sent = flow->second.pending.find(packet.ipId);
+            if (sent == flow->second.pending.end())
+            {
+                flow->second.onlySecond++; // Perdido antes do 1º ponto, num fluxo de descida
+                return;
+            }
+            flow->second.offsets.push_back(packet.time - sent->second);
+            flow->second.pending.erase(sent);
+        });
+
+        // O sentido de cada fluxo é o sinal da maioria das diferenças; a perda é o que passou
+        // pelo ponto a montante e não chegou ao outro
+        for (auto& flow : flows)
+        {
+            FluxoPcap& data = flow.second;
+            std::size_t forward = std::count_if(data.offsets.begin(),
+                                                data.offsets.end(),
+                                                [](double offset) { return offset >= 0; });
+            double sign = 2 * forward >= data.offsets.size() ? 1 : -1;
+            for (double offset : data.offsets)
+            {
+                double delayMs = sign * offset * 1000;
+                data.delaySum += delayMs;
+                data.delayHistogram[uint32_t(std::max(0.0, delayMs) * 10)]++;
+            }
+            data.matched = data.offsets.size();
+            data.unmatched = sign > 0 ? data.pending.size() : data.onlySecond;
+            data.offsets.clear();
+            data.pending.clear();
+        }
+    }
+
+    double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Ordena os fluxos para uma saída estável
+    std::map<ChaveFluxo, const FluxoPcap*> ordered;
+    for (const auto& flow : flows)
+    {
+        ordered[flow.first] = &flow.second;
+    }
+
+    std::cout << std::fixed << std::setprecision(6);
+    std::cout << "Protocolo\tOrigem\t\t\tDestino\t\t\tPacotes\tBytes IP\tTaxa (Mbps)\tGoodput "
+                 "(Mbps)\tRetrans. TCP\tRetries MAC\tIntervalo médio (ms)\tJitter (ms)";
+    if (pair)
+    {
+        std::cout << "\tCasados\tPerda (%)\tAtraso médio (ms)\tp99 (ms)";
+    }
+    std::cout << "\n";
+
+    for (const auto& item : ordered)
+    {
+        const ChaveFluxo& key = item.first;
+        const FluxoPcap& flow = *item.second;
+        double duration = flow.lastTime - flow.firstTime;
+        std::cout << unsigned(key.protocol) << "\t\t" << Endereco(key.source, key.sourcePort)
+                  << "\t" << Endereco(key.destination, key.destinationPort) << "\t"
+                  << flow.packets << "\t" << flow.bytes << "\t\t"
+                  << (duration > 0 ? flow.bytes * 8.0 / duration / 1e6 : 0) << "\t"
+                  << (duration > 0 ? flow.payloadBytes * 8.0 / duration / 1e6 : 0) << "\t"
+                  << flow.tcpRetransmissions << "\t\t" << flow.macRetries << "\t\t"
+                  << (flow.packets > 1 ? flow.interArrivalSum / (flow.packets - 1) * 1000 : 0)
+                  << "\t\t" << flow.jitter * 1000;
+        if (pair)
+        {
+            uint64_t total = flow.matched + flow.unmatched;
+            std::cout << "\t" << flow.matched << "\t"
+                      << (total ? 100.0 * flow.unmatched / total : 0) << "\t"
+                      << (flow.matched ? flow.delaySum / flow.matched : 0) << "\t\t"
+                      << PercentilAtraso(flow.delayHistogram, flow.matched, 0.99);
+        }
+        std::cout << "\n";
+    }
+
+    if (!seriesPath.empty())
+    {
+        std::FILE* output = std::fopen(seriesPath.c_str(), "w");
+        if (!output)
+        {
+            std::cerr << "Não foi possível criar " << seriesPath << "\n";
+            return 1;
+        }
+        std::fprintf(output, "protocol,source,destination,start,bytes,mbps\n");
+        for (const auto& item : ordered)
+        {
+            const ChaveFluxo& key = item.first;
+            std::string source = Endereco(key.source, key.sourcePort);
+            std::string destination = Endereco(key.destination, key.destinationPort);
+            for (std::size_t i = 0; i < item.second->series.size(); i++)
+            {
+                uint64_t bytes = item.second->series[i];
+                std::fprintf(output,
+                             "%u,%s,%s,%.6f,%llu,%.6f\n",
+                             unsigned(key.protocol),
+                             source.c_str(),
+                             destination.c_str(),
+                             i * interval,
+                             static_cast<unsigned long long>(bytes),
+                             bytes * 8.0 / interval / 1e6);
+            }
+        }
+        std::fclose(output);
+    }
+
+    std::cerr << "Processados " << totalRecords << " registros (" << totalBytes / 1e6 << " MB) em "
+              << elapsed << " s: " << (elapsed > 0 ? totalBytes / 1e6 / elapsed : 0) << " MB/s, "
+              << (elapsed > 0 ? totalRecords / elapsed : 0) << " registros/s\n";
+    return 0;
+}
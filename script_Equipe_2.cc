@@ -9,15 +9,3796 @@
 #include "ns3/wifi-module.h"
 #include "ns3/netanim-module.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/traffic-control-module.h"
 
+#ifdef ENABLE_BUILD_VERSION
+#include "ns3/version.h"
+#endif
+
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <fcntl.h>
+#include <fstream>
 #include <iomanip>
+#include <limits>
+#include <numeric>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+
+#ifdef HAVE_SQLITE3
+#include <sqlite3.h>
+#endif
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("ScracthSimulator");
+
+#define SIMULATION_TIME 20.0
+
+// Parâmetros configuráveis pela linha de comando
+uint32_t nClients = 2;              // Número de clientes sem fio
+std::string tcpVariant = "NewReno"; // Controle de congestionamento (NewReno, Cubic, Bbr, Vegas, Westwood)
+uint32_t tcpInitialCwnd = 10;       // Janela de congestionamento inicial (em segmentos)
+uint32_t tcpSegmentSize = 536;      // Tamanho do segmento TCP (bytes)
+uint32_t tcpSndBufSize = 131072;    // Buffer de envio do socket TCP (bytes)
+uint32_t tcpRcvBufSize = 131072;    // Buffer de recepção do socket TCP (bytes)
+std::string queueDisc = "Default";  // Fila no AP e no enlace P2P (Default, None, PfifoFast, FqCoDel, CoDel, Pie, FqCobalt, Red)
+std::string wifiMacQueueSize = "500p"; // Capacidade da fila MAC do Wi-Fi
+std::string p2pDataRate = "100Mbps"; // Taxa do enlace servidor <-> AP
+std::string p2pDelay = "2ms";        // Atraso de propagação do enlace servidor <-> AP
+std::string p2pJitter = "0ms";       // Variação máxima de atraso somada ao atraso de propagação
+std::string p2pErrorModel = "Rate";  // Modelo de perdas no P2P (Rate ou Burst)
+double p2pErrorRate = 0.0;           // Taxa de perda (Rate) ou de início de rajada (Burst)
+uint32_t p2pBurstSize = 3;           // Tamanho máximo da rajada de perdas (pacotes)
+
+std::string trafficMix = "Cbr:100";   // Mistura de modelos de tráfego (Cbr, Bulk, Poisson, Voip, Video, Http) em %
+std::string trafficDataRate = "1Mbps"; // Taxa dos geradores Cbr/Poisson
+uint32_t trafficPacketSize = 1024;     // Tamanho do pacote dos geradores Cbr/Poisson/Bulk (bytes)
+std::string trafficDirection = "Uplink"; // Sentido do tráfego (Uplink, Downlink, Bidirectional)
+std::string startDistribution = "Fixed"; // Início dos clientes (Fixed, Uniform, Poisson, Ramp)
+double startSpread = 1.0;                // Janela em que os inícios são espalhados (s)
+bool capacitySearch = false;     // Busca o maior número de clientes que atende ao SLA
+uint32_t searchMaxClients = 128; // Limite superior da busca de capacidade
+bool loadSweep = false;          // Varre tamanho de pacote x carga por cliente
+std::string sweepPacketSizes = "64,128,256,512,1024,1500"; // Tamanhos da varredura (bytes)
+std::string sweepLoads = "0.1,0.25,0.5,1,2,4";            // Cargas por cliente da varredura (Mbps)
+double slaMaxLoss = 1.0;         // SLA: perda agregada máxima (%)
+double slaMaxP99Delay = 50.0;    // SLA: percentil 99 máximo do atraso (ms)
+double slaMinGoodput = 95.0;     // SLA: goodput mínimo de cada fluxo (% da carga oferecida)
+bool analytic = false;           // Estima a capacidade pelo modelo de Bianchi sem simular
+bool analyticValidate = false;   // Compara a estimativa analítica com a simulação equivalente
+double dcfDataRate = 54;         // Taxa PHY dos quadros de dados no modelo analítico (Mbps)
+double dcfControlRate = 24;      // Taxa PHY dos ACKs no modelo analítico (Mbps)
+bool resultCache = false;                    // Reaproveita resumos de execuções idênticas
+std::string cacheDir = "resultados-cache";   // Diretório do cache de resultados
+std::string outputDir = "resultados"; // Diretório base das saídas de cada execução
+std::string resultsDb = "";           // Banco SQLite de resultados (vazio = desabilitado)
+bool delayLog = false;                // Registra o atraso de cada pacote entregue (atrasos.bin)
+uint32_t flowSampling = 1;            // Amostragem 1-em-N do monitor de fluxos (1 = FlowMonitor completo)
+uint32_t latencySampling = 0;         // Amostragem 1-em-N da decomposição do atraso por salto (0 = desligada)
+bool dropCauses = false;              // Contabiliza a causa de cada descarte por fluxo e por nó
+double telemetryInterval = 0;         // Intervalo da telemetria da fila e do canal no AP (s, 0 = desligada)
+double tcpTraceInterval = 0;          // Intervalo de amostragem dos internos do TCP (s, 0 = desligado)
+double heatmapInterval = 0;           // Intervalo das amostras posição x vazão dos clientes (s, 0 = desligado)
+double heatmapCell = 5.0;             // Lado da célula do mapa de calor (m)
+double churnArrivalRate = 0;          // Chegadas de estações por segundo no modo de rotatividade (0 = desligado)
+double churnSessionMean = 5.0;        // Duração média da sessão de uma estação (s)
+uint32_t churnPool = 1;               // Clientes reservados para a rotatividade (os primeiros do grupo)
+bool qos = false;                     // MACs com QoS (EDCA 802.11e) e marcação TOS por classe
+std::string qosMarking = "Voip:VO,Video:VI,Bulk:BK,Udp:VO,Tcp:BE"; // Classe -> AC ou byte TOS
+std::string qosEdca = "";             // Parâmetros EDCA por AC (vazio = padrão do 802.11)
+std::string clientTopology = "Grid";  // Posição dos clientes (Grid, Ring, Opposite)
+double topologyRadius = 35.0;         // Distância dos clientes ao AP em Ring e Opposite (m)
+uint32_t rtsThreshold = 65535;        // Limiar de RTS/CTS (bytes, 65535 = sem proteção)
+uint32_t fragmentationThreshold = 65535; // Limiar de fragmentação (bytes)
+bool collisionStats = false;          // Conta transmissões de dados e RTS sem resposta
+bool rtsCompare = false;              // Executa sem e com RTS/CTS e compara colisões e vazão
+uint32_t cacheHits = 0;   // Execuções respondidas pelo cache
+uint32_t cacheMisses = 0; // Execuções simuladas por falta no cache
+
+std::string runDir = "."; // Diretório de saída da execução corrente
+std::string runKey = "";  // Hash da configuração da execução corrente
+
+uint64_t p2pTxBytes[2] = {0, 0}; // Bytes transmitidos por direção (0: servidor->AP, 1: AP->servidor)
+
+// Registro de atraso por pacote: (fluxo, tamanho IP, instante de envio, instante de entrega)
+struct RegistroAtraso
+{
+    uint32_t flow;
+    uint32_t size;
+    double txTime;
+    double rxTime;
+};
+
+std::FILE* delayLogFile = nullptr;                        // Arquivo atrasos.bin da execução
+std::unordered_map<uint64_t, double> delayLogPending;     // UID do pacote -> instante de envio
+std::map<Ipv4FlowClassifier::FiveTuple, uint32_t> delayLogFlows; // 5-tupla -> índice do fluxo
+
+// Contadores de tamanho fixo de um fluxo no monitor amostrado (apenas pacotes amostrados)
+const uint32_t sampledDelayBins = 512; // Bins de 1 ms; atrasos maiores vão para o contador de excesso
+const double sampledLossTimeout = 10.0; // Mesmo MaxPerHopDelay padrão do FlowMonitor (s)
+
+struct ContadoresAmostrados
+{
+    uint32_t txPackets = 0;
+    uint32_t rxPackets = 0;
+    uint32_t lostPackets = 0;
+    uint64_t txBytes = 0;
+    uint64_t rxBytes = 0;
+    double rxBytesSquares = 0;
+    double delaySum = 0;
+    double delaySquares = 0;
+    double jitterSum = 0;
+    double lastDelay = -1;
+    double firstTx = 0;
+    double lastTx = 0;
+    double firstRx = 0;
+    double lastRx = 0;
+    std::array<uint32_t, sampledDelayBins> delayBins{};
+    uint32_t delayOverflow = 0;
+    double delayOverflowSum = 0;
+};
+
+Ptr<Ipv4FlowClassifier> sampledClassifier;       // Classificador usado só nos pacotes amostrados
+std::vector<ContadoresAmostrados> sampledFlows; // Indexado pelo FlowId
+std::unordered_map<uint64_t, std::pair<FlowId, double>> sampledInFlight; // UID -> (fluxo, envio)
+std::size_t sampledPeakInFlight = 0;
+
+// Instantes de um pacote amostrado em cada ponto do caminho (-1 = ponto não atravessado)
+struct CarimbosPacote
+{
+    double send = -1;
+    double wifiEnqueue = -1;
+    double wifiAccess = -1;  // Início da espera pelo meio: chegada à cabeça da fila
+    double wifiTxFirst = -1; // Início da primeira transmissão
+    double wifiTxEnd = -1;   // Fim da última transmissão (inclui retransmissões)
+    double p2pEnqueue = -1;
+    double p2pDequeue = -1;
+    double p2pTxEnd = -1;
+    double p2pRxEnd = -1;
+};
+
+// Componentes do atraso, na ordem de latencyComponents
+const std::vector<std::string> latencyComponents = {"Fila Wi-Fi",
+                                                    "Acesso ao canal",
+                                                    "Transmissão Wi-Fi",
+                                                    "Fila P2P",
+                                                    "Transmissão P2P",
+                                                    "Propagação P2P",
+                                                    "Pilha/qdisc/outros"};
+
+struct LatenciaFluxo
+{
+    uint64_t samples = 0;
+    std::array<double, 7> componentSum{};
+    double totalSum = 0;
+};
+
+std::unordered_map<uint64_t, CarimbosPacote> latencyInFlight; // UID -> instantes já registrados
+std::map<std::pair<uint32_t, AcIndex>, double> wifiLastTxEnd; // Fim do último dado por fila MAC
+std::map<Ipv4FlowClassifier::FiveTuple, LatenciaFluxo> latencyFlows;
+
+// Causas de descarte: cada nome recebe um índice e os contadores são vetores indexados por ele
+std::vector<std::string> dropCauseNames;
+std::map<std::string, uint32_t> dropCauseIds;
+std::map<uint32_t, std::vector<uint64_t>> dropsPerNode;
+std::map<Ipv4FlowClassifier::FiveTuple, std::vector<uint64_t>> dropsPerFlow;
+
+// Telemetria do AP: uma amostra da fila MAC por intervalo e o tempo em cada estado da PHY
+struct AmostraTelemetria
+{
+    double time;
+    uint32_t queuePackets;
+    uint32_t queueBytes;
+    uint64_t departures;
+    double sojournSum;
+    double sojournMax;
+};
+
+std::vector<Ptr<WifiMacQueue>> telemetryQueues;          // Filas MAC do AP (Txop ou uma por AC)
+std::unordered_map<uint64_t, double> telemetryEnqueued;  // UID -> instante de entrada na fila
+std::vector<AmostraTelemetria> telemetrySamples;
+AmostraTelemetria telemetryCurrent{};                    // Saídas da fila no intervalo corrente
+std::map<WifiPhyState, std::vector<double>> telemetryStateTime; // Estado -> segundos por intervalo
+
+// Mapa de calor: acumulado de cada cliente no intervalo corrente e de cada célula da grade
+struct AcumuladoPosicao
+{
+    uint64_t bytes = 0;
+    double snrSum = 0;
+    double rateSum = 0;
+    uint32_t frames = 0;
+};
+
+struct CelulaMapa
+{
+    uint32_t samples = 0;
+    double mbpsSum = 0;
+    double mbpsMin = std::numeric_limits<double>::infinity();
+    double snrSum = 0;
+    double rateSum = 0;
+    uint32_t rateSamples = 0;
+};
+
+std::map<Mac48Address, uint32_t> heatmapStations;       // Endereço MAC da estação -> nó
+std::map<uint32_t, AcumuladoPosicao> heatmapCurrent;    // Nó do cliente -> intervalo corrente
+std::map<std::pair<int32_t, int32_t>, CelulaMapa> heatmapGrid; // Célula (x, y) -> acumulado
+
+// Fluxo de dados instalado, indexado por (protocolo, endereço e porta do socket que escuta)
+struct FlowInfo
+{
+    std::string model;     // Modelo de tráfego
+    std::string direction; // Sentido dos dados (Uplink ou Downlink)
+    bool dataFromListener; // Verdadeiro quando os dados partem do lado que escuta (HTTP)
+    double offeredBps;     // Carga média oferecida pelo gerador (0 quando não é conhecida)
+    double startTime;      // Instante de início do gerador (s)
+    double stopTime;       // Instante de parada do gerador (s)
+};
+
+std::map<std::tuple<uint8_t, Ipv4Address, uint16_t>, FlowInfo> registeredFlows;
+
+// Início escalonado dos clientes: deslocamento de cada cliente em relação a 2 s, instante da
+// associação de cada estação e bytes recebidos pelos PacketSink em intervalos de 100 ms
+const double trafficStartTime = 2.0;
+const double startBinWidth = 0.1;
+std::vector<double> clientStartOffsets;
+std::map<uint32_t, double> associationTimes; // Nó -> instante da primeira associação
+std::vector<uint64_t> sinkRxBins;
+
+// Rotatividade de clientes: as sessões são sorteadas antes da simulação e distribuídas entre as
+// estações do grupo reservado, que ficam com o rádio desligado fora das sessões. Entre duas sessões
+// a estação fica livre por churnGuard, tempo para perder os beacons e se desassociar.
+const double churnAssociationLead = 0.5; // Da ligação do rádio ao início dos geradores (s)
+const double churnGuard = 1.5;           // Intervalo mínimo entre sessões na mesma estação (s)
+const double churnBinWidth = 0.5;        // Janela da série dos fluxos existentes (s)
+const uint16_t churnPortStride = 1000;   // Deslocamento de porta entre sessões da mesma estação
+
+struct SessaoRotatividade
+{
+    uint32_t slot;              // Estação do grupo reservado
+    double arrival;             // Ligação do rádio (s)
+    double departure;           // Parada dos geradores (s)
+    double association = -1;    // Associação observada (s, -1 = não associou)
+    double disassociation = -1; // Desassociação observada (s)
+};
+
+struct JanelaRotatividade
+{
+    double time = 0;
+    uint32_t active = 0;     // Sessões com geradores ligados no fim da janela
+    uint32_t associated = 0; // Estações do grupo reservado associadas no fim da janela
+    uint64_t bytes = 0;      // Bytes entregues dos fluxos existentes
+    double delaySum = 0;     // Soma dos atrasos dos fluxos existentes (s)
+    uint64_t packets = 0;
+};
+
+std::vector<SessaoRotatividade> churnSessions;
+bool churnScheduled = false;
+uint32_t churnSlots = 0;                      // Estações do grupo reservado que recebem sessões
+uint32_t churnBlocked = 0;                    // Chegadas sem estação livre no grupo reservado
+std::map<uint32_t, uint32_t> churnNodeSlot;   // Nó -> estação do grupo reservado
+std::set<uint32_t> churnAssociatedNodes;
+std::set<Ipv4Address> churnAddresses;         // Endereços das estações do grupo reservado
+std::unordered_map<uint64_t, double> churnInFlight; // UID -> envio, só dos fluxos existentes
+JanelaRotatividade churnCurrent;
+std::vector<JanelaRotatividade> churnBins;
+
+// Escada de taxas do vídeo adaptativo (bps), duração do chunk e taxa de pico da transferência
+const std::vector<double> videoBitrates = {0.5e6, 1e6, 2.5e6, 5e6};
+const double videoChunkSeconds = 2.0;
+const double videoPeakRate = 10e6;
+
+// Métricas TCP coletadas por nó transmissor
+struct TcpNodeStats
+{
+    double rttSumMs = 0;          // Soma das amostras de RTT (ms)
+    uint32_t rttSamples = 0;      // Número de amostras de RTT
+    uint32_t txSegments = 0;      // Segmentos de dados transmitidos
+    uint32_t retransmissions = 0; // Segmentos retransmitidos
+};
+
+std::map<uint32_t, TcpNodeStats> tcpStats;                      // Métricas por nó
+std::map<const TcpSocketBase*, SequenceNumber32> tcpHighestSeq; // Maior sequência enviada por socket
+std::set<const TcpSocketBase*> tcpTracedSockets;                 // Sockets com traces conectados
+
+// Registro binário dos internos de um socket TCP (tcp-internos.bin), gravado a cada intervalo
+// apenas para os sockets que mudaram desde a amostra anterior. O arquivo começa com "TCPINT01",
+// o tamanho do registro (uint32) e 4 bytes reservados, seguidos dos registros de 36 bytes sem
+// alinhamento, em ordem de tempo (ver tcp-analyzer).
+#pragma pack(push, 1)
+struct RegistroTcp
+{
+    double time;
+    uint32_t socket;          // Índice em tcp-internos-sockets.csv
+    uint32_t cwnd;            // Bytes
+    uint32_t ssthresh;        // Bytes
+    uint32_t retransmissions; // Acumulado
+    float rttMs;              // Última amostra de RTT
+    float rtoMs;
+    uint8_t congState;        // TcpSocketState::TcpCongState_t
+    uint8_t padding[3];
+};
+#pragma pack(pop)
+static_assert(sizeof(RegistroTcp) == 36, "tcp-internos.bin usa registros de 36 bytes");
+
+// Último valor de cada variável de um socket; os traces só atualizam estes campos
+struct InternosTcp
+{
+    Ptr<TcpSocketBase> socket; // Mantém o socket vivo até o fim da execução
+    uint32_t nodeId;
+    std::string local;
+    std::string peer;
+    RegistroTcp last;
+    bool changed;
+    uint32_t samples;
+    double cwndArea;  // Integral da cwnd no tempo (bytes x s)
+    double cwndSince; // Início do valor atual da cwnd (-1 = ainda sem valor)
+    double cwndStart; // Primeiro valor da cwnd
+    uint32_t cwndMax;
+    double rttSumMs;
+    uint32_t rttSamples;
+    float rtoMaxMs;
+    uint32_t recoveries; // Entradas em CA_RECOVERY (retransmissão rápida)
+    uint32_t timeouts;   // Entradas em CA_LOSS (RTO)
+};
+
+std::FILE* tcpInternalsFile = nullptr;
+std::vector<InternosTcp> tcpInternals;
+std::unordered_map<const TcpSocketBase*, uint32_t> tcpInternalsIndex; // Socket -> índice
+double tcpInternalsLastSample = 0; // Instante da última amostragem
+
+// Resumo da última execução, usado pela busca de capacidade
+struct ResumoExecucao
+{
+    double offeredMbps = 0;     // Carga oferecida agregada dos fluxos de dados
+    double goodputMbps = 0;     // Goodput agregado dos fluxos de dados
+    double lossPercent = 0;     // Perda agregada (%)
+    double p99DelayMs = 0;      // Percentil 99 do atraso (ms)
+    double minGoodputRatio = 0; // Menor razão goodput/carga oferecida entre os fluxos (%)
+    uint32_t flows = 0;         // Fluxos de dados
+    double meanDelayMs = 0;     // Atraso médio dos pacotes entregues (ms)
+    double phyRateMbps = 0;     // Taxa PHY média dos quadros de dados Wi-Fi (0 = não medida)
+    double collisionPercent = 0; // Transmissões de dados Wi-Fi sem ACK (%, 0 = não medida)
+};
+
+ResumoExecucao lastRun;
+uint64_t phyDataBits = 0;  // Bits dos quadros de dados Wi-Fi transmitidos (varredura de carga)
+double phyDataTime = 0;    // Tempo desses bits na taxa PHY de cada quadro (s)
+
+// Contadores de colisão: com terminais ocultos quase toda transmissão sem resposta é colisão
+struct ContadoresColisao
+{
+    uint64_t dataTx = 0;     // Transmissões de quadros de dados (inclui retransmissões)
+    uint64_t dataFailed = 0; // Quadros de dados sem ACK
+    uint64_t rtsTx = 0;      // RTS transmitidos
+    uint64_t rtsFailed = 0;  // RTS sem CTS
+    uint64_t apRxErrors = 0; // Recepções corrompidas no AP
+};
+
+ContadoresColisao collisions;
+
+// Caminho de um arquivo de saída dentro do diretório da execução corrente
+std::string
+Saida(const std::string& name)
+{
+    return runDir + "/" + name;
+}
+
+// Aplica a variante TCP e os tamanhos de segmento/buffer escolhidos
+void
+ConfigurarTcp()
+{
+    const std::map<std::string, std::string> variants = {{"NewReno", "ns3::TcpNewReno"},
+                                                         {"Cubic", "ns3::TcpCubic"},
+                                                         {"Bbr", "ns3::TcpBbr"},
+                                                         {"Vegas", "ns3::TcpVegas"},
+                                                         {"Westwood", "ns3::TcpWestwoodPlus"}};
+    auto it = variants.find(tcpVariant);
+    if (it == variants.end())
+    {
+        NS_FATAL_ERROR("Variante TCP desconhecida: " << tcpVariant);
+    }
+
+    Config::SetDefault("ns3::TcpL4Protocol::SocketType",
+                       TypeIdValue(TypeId::LookupByName(it->second)));
+    Config::SetDefault("ns3::TcpSocket::InitialCwnd", UintegerValue(tcpInitialCwnd));
+    Config::SetDefault("ns3::TcpSocket::SegmentSize", UintegerValue(tcpSegmentSize));
+    Config::SetDefault("ns3::TcpSocket::SndBufSize", UintegerValue(tcpSndBufSize));
+    Config::SetDefault("ns3::TcpSocket::RcvBufSize", UintegerValue(tcpRcvBufSize));
+
+    // O BBR depende de pacing para funcionar corretamente
+    if (tcpVariant == "Bbr")
+    {
+        Config::SetDefault("ns3::TcpSocketState::EnablePacing", BooleanValue(true));
+    }
+}
+
+// Extrai o ID do nó de um contexto do tipo "/NodeList/<id>/..."
+uint32_t
+NodeIdFromContext(const std::string& context)
+{
+    std::size_t start = context.find("/NodeList/") + 10;
+    std::size_t end = context.find('/', start);
+    return std::stoul(context.substr(start, end - start));
+}
+
+void
+TcpRttTrace(std::string context, Time oldRtt, Time newRtt)
+{
+    if (newRtt.IsZero())
+    {
+        return;
+    }
+    TcpNodeStats& nodeStats = tcpStats[NodeIdFromContext(context)];
+    nodeStats.rttSumMs += newRtt.GetSeconds() * 1000;
+    nodeStats.rttSamples++;
+}
+
+void
+TcpTxTrace(std::string context,
+           Ptr<const Packet> packet,
+           const TcpHeader& header,
+           Ptr<const TcpSocketBase> socket)
+{
+    if (packet->GetSize() == 0)
+    {
+        return; // Ignora ACKs puros e segmentos de controle
+    }
+
+    TcpNodeStats& nodeStats = tcpStats[NodeIdFromContext(context)];
+    nodeStats.txSegments++;
+
+    // Um segmento abaixo da maior sequência já enviada é uma retransmissão
+    SequenceNumber32 end = header.GetSequenceNumber() + packet->GetSize();
+    auto it = tcpHighestSeq.find(PeekPointer(socket));
+    if (it == tcpHighestSeq.end())
+    {
+        tcpHighestSeq[PeekPointer(socket)] = end;
+    }
+    else if (header.GetSequenceNumber() < it->second)
+    {
+        nodeStats.retransmissions++;
+        auto internals = tcpInternalsIndex.find(PeekPointer(socket));
+        if (internals != tcpInternalsIndex.end())
+        {
+            tcpInternals[internals->second].last.retransmissions++;
+            tcpInternals[internals->second].changed = true;
+        }
+    }
+    else
+    {
+        it->second = end;
+    }
+}
+
+void
+InternosCwndTrace(uint32_t index, uint32_t oldValue, uint32_t newValue)
+{
+    InternosTcp& internals = tcpInternals[index];
+    double now = Simulator::Now().GetSeconds();
+    if (internals.cwndSince < 0)
+    {
+        internals.cwndStart = now;
+    }
+    else
+    {
+        internals.cwndArea += double(internals.last.cwnd) * (now - internals.cwndSince);
+    }
+    internals.cwndSince = now;
+    internals.last.cwnd = newValue;
+    internals.cwndMax = std::max<uint32_t>(internals.cwndMax, newValue);
+    internals.changed = true;
+}
+
+void
+InternosSsthreshTrace(uint32_t index, uint32_t oldValue, uint32_t newValue)
+{
+    tcpInternals[index].last.ssthresh = newValue;
+    tcpInternals[index].changed = true;
+}
+
+void
+InternosRttTrace(uint32_t index, Time oldValue, Time newValue)
+{
+    InternosTcp& internals = tcpInternals[index];
+    internals.last.rttMs = newValue.GetSeconds() * 1000;
+    internals.rttSumMs += internals.last.rttMs;
+    internals.rttSamples++;
+    internals.changed = true;
+}
+
+void
+InternosRtoTrace(uint32_t index, Time oldValue, Time newValue)
+{
+    InternosTcp& internals = tcpInternals[index];
+    internals.last.rtoMs = newValue.GetSeconds() * 1000;
+    internals.rtoMaxMs = std::max(internals.rtoMaxMs, internals.last.rtoMs);
+    internals.changed = true;
+}
+
+void
+InternosCongStateTrace(uint32_t index,
+                       TcpSocketState::TcpCongState_t oldState,
+                       TcpSocketState::TcpCongState_t newState)
+{
+    InternosTcp& internals = tcpInternals[index];
+    internals.last.congState = newState;
+    internals.recoveries += newState == TcpSocketState::CA_RECOVERY && oldState != newState;
+    internals.timeouts += newState == TcpSocketState::CA_LOSS && oldState != newState;
+    internals.changed = true;
+}
+
+// Endereço "ip:porta" de um socket, ou vazio se ainda não definido
+std::string
+EnderecoSocket(const Address& address)
+{
+    if (!InetSocketAddress::IsMatchingType(address))
+    {
+        return "";
+    }
+    std::ostringstream text;
+    text << InetSocketAddress::ConvertFrom(address).GetIpv4() << ":"
+         << InetSocketAddress::ConvertFrom(address).GetPort();
+    return text.str();
+}
+
+// Conecta os traces de internos a um socket. Cada trace apenas guarda o valor mais recente;
+// o custo de gravação fica na amostragem periódica, independente da frequência dos eventos.
+void
+ConectarInternosSocket(Ptr<TcpSocketBase> socket, uint32_t nodeId)
+{
+    uint32_t index = tcpInternals.size();
+    InternosTcp internals{};
+    internals.socket = socket;
+    internals.nodeId = nodeId;
+    internals.last.socket = index;
+    internals.cwndSince = -1;
+    internals.changed = true;
+    tcpInternals.push_back(internals);
+    tcpInternalsIndex[PeekPointer(socket)] = index;
+
+    socket->TraceConnectWithoutContext("CongestionWindow",
+                                       MakeBoundCallback(&InternosCwndTrace, index));
+    socket->TraceConnectWithoutContext("SlowStartThreshold",
+                                       MakeBoundCallback(&InternosSsthreshTrace, index));
+    socket->TraceConnectWithoutContext("RTT", MakeBoundCallback(&InternosRttTrace, index));
+    socket->TraceConnectWithoutContext("RTO", MakeBoundCallback(&InternosRtoTrace, index));
+    socket->TraceConnectWithoutContext("CongState",
+                                       MakeBoundCallback(&InternosCongStateTrace, index));
+}
+
+// Grava um registro para cada socket que mudou no intervalo
+void
+AmostrarInternosTcp()
+{
+    double now = Simulator::Now().GetSeconds();
+    tcpInternalsLastSample = now;
+    for (InternosTcp& internals : tcpInternals)
+    {
+        if (internals.local.empty())
+        {
+            // Os sockets do lado que aceita a conexão só têm endereços depois do handshake
+            Address local;
+            Address peer;
+            if (internals.socket->GetSockName(local) == 0 &&
+                internals.socket->GetPeerName(peer) == 0)
+            {
+                internals.local = EnderecoSocket(local);
+                internals.peer = EnderecoSocket(peer);
+            }
+        }
+        if (!internals.changed)
+        {
+            continue;
+        }
+        internals.changed = false;
+        internals.last.time = now;
+        internals.samples++;
+        std::fwrite(&internals.last, sizeof(RegistroTcp), 1, tcpInternalsFile);
+    }
+    Simulator::Schedule(Seconds(tcpTraceInterval), &AmostrarInternosTcp);
+}
+
+// Abre tcp-internos.bin e inicia a amostragem. Os sockets entram à medida que
+// ConectarRastreamentoTcp os encontra.
+void
+ConectarInternosTcp()
+{
+    if (tcpTraceInterval <= 0)
+    {
+        return;
+    }
+    tcpInternalsFile = std::fopen(Saida("tcp-internos.bin").c_str(), "wb");
+    if (!tcpInternalsFile)
+    {
+        NS_FATAL_ERROR("Não foi possível criar " << Saida("tcp-internos.bin"));
+    }
+    std::setvbuf(tcpInternalsFile, nullptr, _IOFBF, 1 << 20);
+    const char magic[8] = {'T', 'C', 'P', 'I', 'N', 'T', '0', '1'};
+    uint32_t recordSize = sizeof(RegistroTcp);
+    uint32_t reserved = 0;
+    std::fwrite(magic, sizeof(magic), 1, tcpInternalsFile);
+    std::fwrite(&recordSize, sizeof(recordSize), 1, tcpInternalsFile);
+    std::fwrite(&reserved, sizeof(reserved), 1, tcpInternalsFile);
+    Simulator::Schedule(Seconds(tcpTraceInterval), &AmostrarInternosTcp);
+}
+
+// Fecha tcp-internos.bin, grava o índice dos sockets e imprime o resumo por socket. A cwnd média
+// é ponderada pelo tempo em que cada valor vigorou, até a última amostragem.
+void
+FecharInternosTcp()
+{
+    if (!tcpInternalsFile)
+    {
+        return;
+    }
+    std::fclose(tcpInternalsFile);
+    tcpInternalsFile = nullptr;
+
+    std::ofstream index(Saida("tcp-internos-sockets.csv"));
+    index << "socket,node,local,peer,samples,cwndMean,cwndMax,rttMeanMs,rtoMaxMs,retransmissions,"
+             "recoveries,timeouts\n";
+    std::cout << "\n\t\t\t|================= Internos do TCP por socket =================|\n";
+    std::cout << "Socket\tNó\tLocal\t\t\tPar\t\t\tcwnd médio (seg.)\tcwnd máx. (seg.)\t"
+                 "RTT médio (ms)\tRTO máx. (ms)\tRetrans.\tRecuperações\tTimeouts\n";
+    for (const InternosTcp& internals : tcpInternals)
+    {
+        double cwndMean = 0;
+        double end = std::max(tcpInternalsLastSample, internals.cwndSince);
+        if (internals.cwndSince >= 0 && end > internals.cwndStart)
+        {
+            double area =
+                internals.cwndArea + double(internals.last.cwnd) * (end - internals.cwndSince);
+            cwndMean = area / (end - internals.cwndStart);
+        }
+        double rttMean = internals.rttSamples ? internals.rttSumMs / internals.rttSamples : 0;
+        index << internals.last.socket << "," << internals.nodeId << "," << internals.local << ","
+              << internals.peer << "," << internals.samples << "," << cwndMean << ","
+              << internals.cwndMax << "," << rttMean << "," << internals.rtoMaxMs << ","
+              << internals.last.retransmissions << "," << internals.recoveries << ","
+              << internals.timeouts << "\n";
+        if (internals.last.retransmissions == 0 && internals.rttSamples == 0)
+        {
+            continue; // Sockets que não enviaram dados (ex.: lado receptor)
+        }
+        std::cout << internals.last.socket << "\t" << internals.nodeId << "\t" << internals.local
+                  << "\t" << internals.peer << "\t" << cwndMean / tcpSegmentSize << "\t\t"
+                  << double(internals.cwndMax) / tcpSegmentSize << "\t\t" << rttMean << "\t"
+                  << internals.rtoMaxMs << "\t" << internals.last.retransmissions << "\t\t"
+                  << internals.recoveries << "\t\t" << internals.timeouts << "\n";
+    }
+    tcpInternals.clear();
+    tcpInternalsIndex.clear();
+}
+
+// Contagem de timeouts do TCP na tabela de causas de descarte (definida junto com as demais causas)
+void TcpCongStateTrace(const TcpSocketBase* socket,
+                       uint32_t nodeId,
+                       TcpSocketState::TcpCongState_t oldState,
+                       TcpSocketState::TcpCongState_t newState);
+
+// Conecta os traces de RTT e transmissão aos sockets TCP já criados no nó. Cada socket é
+// conectado uma única vez, pois o mesmo nó pode transmitir vários fluxos (ex.: o servidor no
+// tráfego de descida).
+void
+ConectarRastreamentoTcp(uint32_t nodeId)
+{
+    std::ostringstream context;
+    context << "/NodeList/" << nodeId << "/$ns3::TcpL4Protocol/SocketList";
+
+    ObjectVectorValue sockets;
+    NodeList::GetNode(nodeId)->GetObject<TcpL4Protocol>()->GetAttribute("SocketList", sockets);
+    for (auto it = sockets.Begin(); it != sockets.End(); it++)
+    {
+        Ptr<TcpSocketBase> socket = DynamicCast<TcpSocketBase>(it->second);
+        if (!socket || !tcpTracedSockets.insert(PeekPointer(socket)).second)
+        {
+            continue;
+        }
+        socket->TraceConnect("RTT", context.str(), MakeCallback(&TcpRttTrace));
+        socket->TraceConnect("Tx", context.str(), MakeCallback(&TcpTxTrace));
+        if (tcpTraceInterval > 0)
+        {
+            ConectarInternosSocket(socket, nodeId);
+        }
+        if (dropCauses)
+        {
+            socket->TraceConnectWithoutContext(
+                "CongState",
+                MakeBoundCallback(&TcpCongStateTrace,
+                                  static_cast<const TcpSocketBase*>(PeekPointer(socket)),
+                                  nodeId));
+        }
+    }
+}
+
+// O servidor HTTP só cria o socket que transmite as páginas ao aceitar a conexão do cliente,
+// depois do agendamento inicial de ConectarRastreamentoTcp
+void
+ConexaoHttpTrace(uint32_t nodeId, Ptr<const ThreeGppHttpServer> httpServer, Ptr<Socket> socket)
+{
+    ConectarRastreamentoTcp(nodeId);
+}
+
+// Bytes de aplicação de um contador do FlowMonitor, que inclui os cabeçalhos IPv4 e de
+// transporte de cada pacote. O TCP do ns-3 leva a opção de timestamp (12 bytes) nos segmentos.
+double
+BytesAplicacao(uint8_t protocol, uint64_t bytes, uint64_t packets)
+{
+    uint32_t headers = 20 + (protocol == 6 ? 20 + 12 : 8);
+    return std::max(0.0, double(bytes) - double(packets) * headers);
+}
+
+// Busca do fluxo registrado e goodput sobre o tempo ativo do gerador (definidas mais adiante)
+const FlowInfo* BuscarFluxo(const Ipv4FlowClassifier::FiveTuple& t, bool& data);
+double GoodputFluxo(const Ipv4FlowClassifier::FiveTuple& t,
+                    const FlowMonitor::FlowStats& flowStats,
+                    double simulationTime);
+
+// Relatório de goodput, RTT e retransmissões por cliente TCP
+void
+ImprimirRelatorioTcp(const std::map<FlowId, FlowMonitor::FlowStats>& stats,
+                     Ptr<Ipv4FlowClassifier> classifier,
+                     double simulationTime)
+{
+    std::cout << "\t\t\t|================= Métricas TCP (" << tcpVariant
+              << ") =================|\n";
+    std::cout << "Nó\tOrigem\t\tGoodput (Mbps)\tRTT médio (ms)\tSegmentos\tRetransmissões\n";
+
+    double totalGoodput = 0;
+    uint32_t totalSegments = 0;
+    uint32_t totalRetransmissions = 0;
+    for (const auto& entry : tcpStats)
+    {
+        Ipv4Address address =
+            NodeList::GetNode(entry.first)->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal();
+
+        double goodput = 0;
+        for (const auto& flow : stats)
+        {
+            Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(flow.first);
+            if (t.protocol == 6 && t.sourceAddress == address)
+            {
+                goodput += GoodputFluxo(t, flow.second, simulationTime);
+            }
+        }
+
+        const TcpNodeStats& nodeStats = entry.second;
+        double averageRttMs =
+            nodeStats.rttSamples ? nodeStats.rttSumMs / nodeStats.rttSamples : 0;
+
+        std::cout << entry.first << "\t" << address << "\t" << std::setw(5) << goodput << "\t"
+                  << std::setw(5) << averageRttMs << "\t" << nodeStats.txSegments << "\t\t"
+                  << nodeStats.retransmissions << "\n";
+
+        totalGoodput += goodput;
+        totalSegments += nodeStats.txSegments;
+        totalRetransmissions += nodeStats.retransmissions;
+    }
+
+    std::cout << "Total\t\t\t" << std::setw(5) << totalGoodput << "\t\t\t" << totalSegments
+              << "\t\t" << totalRetransmissions << " ("
+              << (totalSegments ? 100.0 * totalRetransmissions / totalSegments : 0)
+              << "% retransmitidos)\n";
+}
+
+// Reposiciona os clientes ao redor do AP. Grid mantém a grade compacta de cada cenário, em que
+// todos se escutam. Ring os distribui num círculo de raio topologyRadius; Opposite os divide em
+// dois grupos, com 2 m entre vizinhos, em lados opostos do AP. No canal padrão (log-distância,
+// expoente 3) o preâmbulo deixa de ser detectado (-82 dBm) a cerca de 51 m, então com o raio
+// padrão de 35 m os clientes afastados são terminais ocultos uns dos outros, mas não do AP.
+void
+PosicionarClientes(NodeContainer clients, Ptr<Node> ap)
+{
+    if (clientTopology == "Grid")
+    {
+        return;
+    }
+    Vector center = ap->GetObject<MobilityModel>()->GetPosition();
+    uint32_t n = clients.GetN();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Vector position = center;
+        if (clientTopology == "Ring")
+        {
+            double angle = 2 * M_PI * i / n;
+            position.x += topologyRadius * std::cos(angle);
+            position.y += topologyRadius * std::sin(angle);
+        }
+        else if (clientTopology == "Opposite")
+        {
+            uint32_t groupSize = (n + 1) / 2;
+            position.x += (i % 2 ? 1 : -1) * topologyRadius;
+            position.y += 2.0 * (i / 2 - (groupSize - 1) / 2.0);
+        }
+        else
+        {
+            NS_FATAL_ERROR("Topologia de clientes desconhecida: " << clientTopology);
+        }
+        clients.Get(i)->GetObject<MobilityModel>()->SetPosition(position);
+    }
+}
+
+// Substitui a fila padrão do AP e dos dispositivos P2P pela disciplina escolhida.
+// "Default" mantém a fila instalada pelo Ipv4AddressHelper e "None" remove qualquer fila,
+// deixando apenas a fila do próprio dispositivo (DropTail).
+void
+InstalarFilas(NetDeviceContainer apDevice, NetDeviceContainer p2pDevices)
+{
+    if (queueDisc == "Default")
+    {
+        return;
+    }
+
+    // FqCobalt é o equivalente ao CAKE disponível no ns-3 (filas justas com AQM COBALT)
+    const std::map<std::string, std::string> queueDiscs = {{"PfifoFast", "ns3::PfifoFastQueueDisc"},
+                                                           {"FqCoDel", "ns3::FqCoDelQueueDisc"},
+                                                           {"CoDel", "ns3::CoDelQueueDisc"},
+                                                           {"Pie", "ns3::PieQueueDisc"},
+                                                           {"FqCobalt", "ns3::FqCobaltQueueDisc"},
+                                                           {"Red", "ns3::RedQueueDisc"}};
+
+    NetDeviceContainer devices(apDevice, p2pDevices);
+    TrafficControlHelper tch;
+    tch.Uninstall(devices);
+
+    if (queueDisc == "None")
+    {
+        return;
+    }
+
+    auto it = queueDiscs.find(queueDisc);
+    if (it == queueDiscs.end())
+    {
+        NS_FATAL_ERROR("Disciplina de fila desconhecida: " << queueDisc);
+    }
+    tch.SetRootQueueDisc(it->second);
+    tch.Install(p2pDevices);
+
+    if (!qos)
+    {
+        tch.Install(apDevice);
+        return;
+    }
+    // Com QoS o dispositivo Wi-Fi tem uma fila por AC: uma disciplina filha por fila sob a mq
+    TrafficControlHelper mq;
+    uint16_t handle = mq.SetRootQueueDisc("ns3::MqQueueDisc");
+    TrafficControlHelper::ClassIdList classes =
+        mq.AddQueueDiscClasses(handle, 4, "ns3::QueueDiscClass");
+    mq.AddChildQueueDiscs(handle, classes, it->second);
+    mq.Install(apDevice);
+}
+
+// Sorteia um novo atraso para o canal P2P dentro de [p2pDelay, p2pDelay + p2pJitter]
+void
+VariarAtrasoP2P(Ptr<PointToPointChannel> channel, Ptr<UniformRandomVariable> jitter)
+{
+    Time delay = Time(p2pDelay) + Seconds(jitter->GetValue(0, Time(p2pJitter).GetSeconds()));
+    channel->SetAttribute("Delay", TimeValue(delay));
+    Simulator::Schedule(MilliSeconds(10), &VariarAtrasoP2P, channel, jitter);
+}
+
+void
+P2pTxTrace(uint32_t direction, Ptr<const Packet> packet)
+{
+    p2pTxBytes[direction] += packet->GetSize();
+}
+
+// Instala o modelo de perdas, a variação de atraso e a contagem de bytes no enlace P2P
+void
+ConfigurarEnlaceP2P(NetDeviceContainer p2pDevices)
+{
+    p2pTxBytes[0] = 0;
+    p2pTxBytes[1] = 0;
+
+    for (uint32_t i = 0; i < p2pDevices.GetN(); i++)
+    {
+        p2pDevices.Get(i)->TraceConnectWithoutContext("PhyTxEnd", MakeBoundCallback(&P2pTxTrace, i));
+
+        if (p2pErrorRate <= 0)
+        {
+            continue;
+        }
+
+        Ptr<ErrorModel> errorModel;
+        if (p2pErrorModel == "Rate")
+        {
+            errorModel = CreateObjectWithAttributes<RateErrorModel>(
+                "ErrorRate", DoubleValue(p2pErrorRate),
+                "ErrorUnit", EnumValue(RateErrorModel::ERROR_UNIT_PACKET));
+        }
+        else if (p2pErrorModel == "Burst")
+        {
+            std::ostringstream burstSize;
+            burstSize << "ns3::UniformRandomVariable[Min=1|Max=" << p2pBurstSize << "]";
+            errorModel = CreateObjectWithAttributes<BurstErrorModel>(
+                "ErrorRate", DoubleValue(p2pErrorRate),
+                "BurstSize", StringValue(burstSize.str()));
+        }
+        else
+        {
+            NS_FATAL_ERROR("Modelo de perdas desconhecido: " << p2pErrorModel);
+        }
+        p2pDevices.Get(i)->SetAttribute("ReceiveErrorModel", PointerValue(errorModel));
+    }
+
+    if (Time(p2pJitter).IsStrictlyPositive())
+    {
+        Ptr<PointToPointChannel> channel =
+            DynamicCast<PointToPointChannel>(p2pDevices.Get(0)->GetChannel());
+        Simulator::Schedule(Seconds(0), &VariarAtrasoP2P, channel,
+                            CreateObject<UniformRandomVariable>());
+    }
+}
+
+// Utilização de cada direção do enlace P2P frente ao goodput agregado dos fluxos de dados. A
+// utilização cobre tudo o que passou pelo enlace na simulação inteira; o goodput conta só os
+// bytes de aplicação dos fluxos de dados (sem ACKs do TCP e pedidos HTTP) no tempo ativo de cada
+// um.
+void
+ImprimirUtilizacaoEnlaces(const std::map<FlowId, FlowMonitor::FlowStats>& stats,
+                          Ptr<Ipv4FlowClassifier> classifier,
+                          double simulationTime)
+{
+    double capacity = DataRate(p2pDataRate).GetBitRate() * simulationTime;
+
+    double goodput = 0;
+    for (const auto& flow : stats)
+    {
+        Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(flow.first);
+        bool data = false;
+        if (BuscarFluxo(t, data) && data)
+        {
+            goodput += GoodputFluxo(t, flow.second, simulationTime);
+        }
+    }
+
+    std::cout << "\t\t\t|================= Enlace P2P (" << p2pDataRate << ", " << p2pDelay
+              << ") =================|\n";
+    std::cout << "Direção\t\tBytes\t\tUtilização (%)\n";
+    std::cout << "Servidor->AP\t" << p2pTxBytes[0] << "\t\t" << std::setw(5)
+              << 100.0 * p2pTxBytes[0] * 8 / capacity << "\n";
+    std::cout << "AP->Servidor\t" << p2pTxBytes[1] << "\t\t" << std::setw(5)
+              << 100.0 * p2pTxBytes[1] * 8 / capacity << "\n";
+    std::cout << "Goodput agregado dos fluxos: " << goodput << " Mbps\n";
+}
+
+// Lista de números separados por vírgula de uma opção de linha de comando
+std::vector<double>
+ListaNumeros(const std::string& option, const std::string& value)
+{
+    std::vector<double> numbers;
+    std::istringstream entries(value);
+    std::string entry;
+    while (std::getline(entries, entry, ','))
+    {
+        char* end = nullptr;
+        errno = 0;
+        double number = std::strtod(entry.c_str(), &end);
+        while (std::isspace(static_cast<unsigned char>(*end)))
+        {
+            end++;
+        }
+        if (end == entry.c_str() || *end != '\0' || errno == ERANGE)
+        {
+            NS_FATAL_ERROR("Valor inválido em " << option << ": \"" << entry << "\"");
+        }
+        numbers.push_back(number);
+    }
+    if (numbers.empty())
+    {
+        NS_FATAL_ERROR(option << " vazia");
+    }
+    return numbers;
+}
+
+// Marcação TOS do fluxo segundo qosMarking. As chaves são "Modelo/Transporte", "Modelo" ou
+// "Transporte" (Udp, Tcp), nessa ordem de precedência; o valor é uma categoria de acesso (VO, VI,
+// BE, BK), marcada com a precedência IP que o ns-3 mapeia para ela, ou um byte TOS numérico.
+// O HTTP não tem como marcar os sockets e fica sempre em BE.
+uint8_t
+TosDoFluxo(bool tcp, const std::string& model)
+{
+    if (model == "Http")
+    {
+        return 0;
+    }
+    const std::map<std::string, uint8_t> categories = {{"VO", 0xc0},
+                                                       {"VI", 0xa0},
+                                                       {"BE", 0x00},
+                                                       {"BK", 0x20}};
+    std::string transport = tcp ? "Tcp" : "Udp";
+    std::map<std::string, std::string> marking;
+    std::istringstream entries(qosMarking);
+    std::string entry;
+    while (std::getline(entries, entry, ','))
+    {
+        std::size_t colon = entry.find(':');
+        if (colon == std::string::npos)
+        {
+            NS_FATAL_ERROR("Entrada inválida em qosMarking: " << entry);
+        }
+        marking[entry.substr(0, colon)] = entry.substr(colon + 1);
+    }
+
+    for (const std::string& key : {model + "/" + transport, model, transport})
+    {
+        auto it = marking.find(key);
+        if (it != marking.end())
+        {
+            auto category = categories.find(it->second);
+            return category != categories.end() ? category->second
+                                                : uint8_t(std::stoul(it->second, nullptr, 0));
+        }
+    }
+    return 0;
+}
+
+// Escolhe o modelo de tráfego do cliente de acordo com as porcentagens de trafficMix
+std::string
+ModeloDeTrafego(uint32_t clientIndex, uint32_t groupSize)
+{
+    std::vector<std::pair<std::string, double>> mix;
+    double total = 0;
+    std::istringstream entries(trafficMix);
+    std::string entry;
+    while (std::getline(entries, entry, ','))
+    {
+        std::size_t colon = entry.find(':');
+        if (colon == std::string::npos)
+        {
+            NS_FATAL_ERROR("Entrada inválida em trafficMix: " << entry);
+        }
+        mix.emplace_back(entry.substr(0, colon), std::stod(entry.substr(colon + 1)));
+        total += mix.back().second;
+    }
+
+    // Os clientes são distribuídos em ordem pelas faixas acumuladas da mistura
+    double position = (clientIndex + 0.5) / groupSize * total;
+    double accumulated = 0;
+    for (const auto& model : mix)
+    {
+        accumulated += model.second;
+        if (position < accumulated)
+        {
+            return model.first;
+        }
+    }
+    return mix.back().first;
+}
+
+// Carga média oferecida pelos geradores OnOff; os demais modelos dependem da rede
+double
+TaxaOferecida(const std::string& model)
+{
+    if (model == "Cbr")
+    {
+        return DataRate(trafficDataRate).GetBitRate();
+    }
+    if (model == "Poisson")
+    {
+        return DataRate(trafficDataRate).GetBitRate() * 0.5;
+    }
+    if (model == "Voip")
+    {
+        return 64000 * 1.004 / (1.004 + 1.587);
+    }
+    return 0;
+}
+
+std::string
+VariavelConstante(double value)
+{
+    std::ostringstream variable;
+    variable << "ns3::ConstantRandomVariable[Constant=" << value << "]";
+    return variable.str();
+}
+
+// Ajusta o período ligado/desligado do vídeo para transferir um chunk do degrau escolhido
+void
+ConfigurarChunkVideo(Ptr<OnOffApplication> app, uint32_t rung)
+{
+    double onTime = videoBitrates[rung] * videoChunkSeconds / videoPeakRate;
+    app->SetAttribute("OnTime", StringValue(VariavelConstante(onTime)));
+    app->SetAttribute("OffTime", StringValue(VariavelConstante(videoChunkSeconds - onTime)));
+}
+
+// A cada chunk compara os bytes entregues com o esperado e sobe/desce na escada de taxas
+void
+AdaptarVideo(Ptr<OnOffApplication> app, Ptr<PacketSink> sink, uint32_t rung, uint64_t lastRx)
+{
+    uint64_t received = sink->GetTotalRx() - lastRx;
+    double expected = videoBitrates[rung] * videoChunkSeconds / 8;
+    if (received >= 0.95 * expected && rung + 1 < videoBitrates.size())
+    {
+        rung++;
+    }
+    else if (received < 0.8 * expected && rung > 0)
+    {
+        rung--;
+    }
+    ConfigurarChunkVideo(app, rung);
+    Simulator::Schedule(Seconds(videoChunkSeconds),
+                        &AdaptarVideo,
+                        app,
+                        sink,
+                        rung,
+                        sink->GetTotalRx());
+}
+
+// Deslocamento do início do cliente, sorteado na primeira chamada para todos os clientes:
+// Uniform espalha uniformemente em [0, startSpread], Poisson usa chegadas com intervalos
+// exponenciais de média startSpread / nClients e Ramp distribui os clientes em intervalos iguais.
+// A cauda da Poisson é limitada a startSpread, que precisa terminar antes do fim da simulação.
+double
+DeslocamentoInicio(uint32_t clientIndex)
+{
+    if (clientStartOffsets.empty())
+    {
+        if (startSpread < 0 || startSpread >= SIMULATION_TIME - trafficStartTime)
+        {
+            NS_FATAL_ERROR("startSpread (" << startSpread << " s) deve ficar em [0, "
+                                           << SIMULATION_TIME - trafficStartTime << ") s");
+        }
+        clientStartOffsets.assign(nClients, 0);
+        if (startDistribution == "Uniform")
+        {
+            Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable>();
+            for (double& offset : clientStartOffsets)
+            {
+                offset = uniform->GetValue(0, startSpread);
+            }
+        }
+        else if (startDistribution == "Poisson")
+        {
+            Ptr<ExponentialRandomVariable> interval = CreateObject<ExponentialRandomVariable>();
+            interval->SetAttribute("Mean", DoubleValue(startSpread / nClients));
+            double time = 0;
+            for (double& offset : clientStartOffsets)
+            {
+                offset = std::min(time, startSpread);
+                time += interval->GetValue();
+            }
+        }
+        else if (startDistribution == "Ramp")
+        {
+            for (uint32_t i = 0; i < nClients; i++)
+            {
+                clientStartOffsets[i] = nClients > 1 ? startSpread * i / (nClients - 1) : 0;
+            }
+        }
+        else if (startDistribution != "Fixed")
+        {
+            NS_FATAL_ERROR("Distribuição de início desconhecida: " << startDistribution);
+        }
+    }
+    return clientIndex < clientStartOffsets.size() ? clientStartOffsets[clientIndex] : 0;
+}
+
+// Instante de início dos geradores do cliente
+double
+InicioCliente(uint32_t clientIndex)
+{
+    return trafficStartTime + DeslocamentoInicio(clientIndex);
+}
+
+// Instante em que o primeiro gerador começa
+double
+InicioTrafego()
+{
+    DeslocamentoInicio(0);
+    double first = trafficStartTime;
+    for (uint32_t i = 0; i < clientStartOffsets.size(); i++)
+    {
+        first = i == 0 ? InicioCliente(i) : std::min(first, InicioCliente(i));
+    }
+    return first;
+}
+
+// Sorteia uma única vez as sessões de todo o grupo reservado: chegadas de Poisson com taxa
+// churnArrivalRate a partir de 2 s e duração exponencial de média churnSessionMean. Cada chegada
+// ocupa a estação livre há mais tempo; sem estação livre a chegada é bloqueada. O grupo
+// reservado precisa deixar ao menos um cliente fixo no grupo, cujos fluxos são os medidos.
+const std::vector<SessaoRotatividade>&
+SessoesRotatividade(uint32_t groupSize)
+{
+    if (churnScheduled || churnArrivalRate <= 0)
+    {
+        return churnSessions;
+    }
+    churnScheduled = true;
+    if (churnPool == 0 || churnPool >= groupSize)
+    {
+        NS_FATAL_ERROR("churnPool (" << churnPool << ") deve ficar entre 1 e " << groupSize - 1
+                                     << ", o número de clientes do grupo menos um");
+    }
+    churnSlots = std::min(churnPool, groupSize);
+
+    Ptr<ExponentialRandomVariable> interval = CreateObject<ExponentialRandomVariable>();
+    interval->SetAttribute("Mean", DoubleValue(1 / churnArrivalRate));
+    Ptr<ExponentialRandomVariable> length = CreateObject<ExponentialRandomVariable>();
+    length->SetAttribute("Mean", DoubleValue(churnSessionMean));
+
+    std::vector<double> freeAt(churnSlots, 0);
+    for (double time = trafficStartTime + interval->GetValue(); time < SIMULATION_TIME;
+         time += interval->GetValue())
+    {
+        double departure = std::min(time + length->GetValue(), double(SIMULATION_TIME));
+        auto slot = std::min_element(freeAt.begin(), freeAt.end());
+        if (*slot > time)
+        {
+            churnBlocked++;
+            continue;
+        }
+        *slot = departure + churnGuard;
+        if (departure > time + churnAssociationLead)
+        {
+            churnSessions.push_back({uint32_t(slot - freeAt.begin()), time, departure});
+        }
+    }
+    return churnSessions;
+}
+
+// Instala o receptor e o gerador de um fluxo conforme o modelo de tráfego do cliente.
+// No sentido de descida o servidor gera o tráfego e o cliente o recebe.
+void
+InstalarFluxo(std::string socketFactory,
+              Ptr<Node> client,
+              Ipv4Address clientAddress,
+              Ptr<Node> server,
+              Ipv4Address serverAddress,
+              uint16_t port,
+              bool downlink,
+              uint32_t clientIndex,
+              uint32_t groupSize,
+              double start,
+              double stop,
+              double simulationTime)
+{
+    bool tcp = socketFactory == "ns3::TcpSocketFactory";
+    std::string model = ModeloDeTrafego(clientIndex, groupSize);
+    if (!tcp && (model == "Bulk" || model == "Http"))
+    {
+        NS_LOG_WARN("Modelo " << model << " exige TCP; usando Cbr no fluxo UDP " << port);
+        model = "Cbr";
+    }
+
+    Ptr<Node> source = downlink ? server : client;
+    Ptr<Node> sink = downlink ? client : server;
+    Ipv4Address sinkAddress = downlink ? clientAddress : serverAddress;
+
+    ApplicationContainer serverApp;
+    ApplicationContainer clientApps;
+    InetSocketAddress sinkSocketAddress(sinkAddress, port);
+    if (qos)
+    {
+        sinkSocketAddress.SetTos(TosDoFluxo(tcp, model));
+    }
+
+    if (model == "Http")
+    {
+        // Navegação web 3GPP: o cliente sempre pede as páginas ao servidor, então um único
+        // par cliente/servidor HTTP cobre os dois sentidos
+        if (downlink && trafficDirection == "Bidirectional")
+        {
+            return;
+        }
+        registeredFlows[{6, serverAddress, port}] =
+            {model, "Downlink", true, 0, start, stop};
+
+        ThreeGppHttpServerHelper httpServer(serverAddress);
+        httpServer.SetAttribute("LocalPort", UintegerValue(port));
+        serverApp = httpServer.Install(server);
+
+        ThreeGppHttpClientHelper httpClient(serverAddress);
+        httpClient.SetAttribute("RemoteServerPort", UintegerValue(port));
+        clientApps = httpClient.Install(client);
+    }
+    else
+    {
+        registeredFlows[{tcp ? 6 : 17, sinkAddress, port}] = {model,
+                                                               downlink ? "Downlink" : "Uplink",
+                                                               false,
+                                                               TaxaOferecida(model),
+                                                               start,
+                                                               stop};
+
+        PacketSinkHelper sinkHelper(socketFactory, InetSocketAddress(Ipv4Address::GetAny(), port));
+        serverApp = sinkHelper.Install(sink);
+
+        if (model == "Bulk")
+        {
+            // Transferência saturante: envia enquanto houver espaço no buffer do socket
+            BulkSendHelper bulkHelper(socketFactory, sinkSocketAddress);
+            bulkHelper.SetAttribute("SendSize", UintegerValue(trafficPacketSize));
+            clientApps = bulkHelper.Install(source);
+        }
+        else
+        {
+            OnOffHelper onoffHelper(socketFactory, sinkSocketAddress);
+            if (model == "Cbr")
+            {
+                onoffHelper.SetAttribute("DataRate", StringValue(trafficDataRate));
+                onoffHelper.SetAttribute("PacketSize", UintegerValue(trafficPacketSize));
+                onoffHelper.SetAttribute("OnTime", StringValue(VariavelConstante(1.0)));
+                onoffHelper.SetAttribute("OffTime", StringValue(VariavelConstante(0.0)));
+            }
+            else if (model == "Poisson")
+            {
+                // Rajadas com duração e intervalo exponenciais (média de 0,5 s cada)
+                onoffHelper.SetAttribute("DataRate", StringValue(trafficDataRate));
+                onoffHelper.SetAttribute("PacketSize", UintegerValue(trafficPacketSize));
+                onoffHelper.SetAttribute("OnTime",
+                                         StringValue("ns3::ExponentialRandomVariable[Mean=0.5]"));
+                onoffHelper.SetAttribute("OffTime",
+                                         StringValue("ns3::ExponentialRandomVariable[Mean=0.5]"));
+            }
+            else if (model == "Voip")
+            {
+                // G.711: 160 bytes a cada 20 ms durante os períodos de fala (ITU-T P.59)
+                onoffHelper.SetAttribute("DataRate", StringValue("64kbps"));
+                onoffHelper.SetAttribute("PacketSize", UintegerValue(160));
+                onoffHelper.SetAttribute("OnTime",
+                                         StringValue("ns3::ExponentialRandomVariable[Mean=1.004]"));
+                onoffHelper.SetAttribute("OffTime",
+                                         StringValue("ns3::ExponentialRandomVariable[Mean=1.587]"));
+            }
+            else if (model == "Video")
+            {
+                // Chunks transferidos na taxa de pico; a duração depende do degrau de qualidade
+                double onTime = videoBitrates[0] * videoChunkSeconds / videoPeakRate;
+                onoffHelper.SetAttribute("DataRate", DataRateValue(DataRate(videoPeakRate)));
+                onoffHelper.SetAttribute("PacketSize", UintegerValue(1400));
+                onoffHelper.SetAttribute("OnTime", StringValue(VariavelConstante(onTime)));
+                onoffHelper.SetAttribute("OffTime",
+                                         StringValue(VariavelConstante(videoChunkSeconds - onTime)));
+            }
+            else
+            {
+                NS_FATAL_ERROR("Modelo de tráfego desconhecido: " << model);
+            }
+            clientApps = onoffHelper.Install(source);
+
+            if (model == "Video")
+            {
+                Simulator::Schedule(Seconds(start + videoChunkSeconds),
+                                    &AdaptarVideo,
+                                    DynamicCast<OnOffApplication>(clientApps.Get(0)),
+                                    DynamicCast<PacketSink>(serverApp.Get(0)),
+                                    0,
+                                    0);
+            }
+        }
+    }
+
+    serverApp.Start(Seconds(1.0));
+    serverApp.Stop(Seconds(simulationTime));
+    clientApps.Start(Seconds(start));
+    clientApps.Stop(Seconds(stop));
+
+    // Conecta os traces de RTT e retransmissões após a criação do socket transmissor; no HTTP
+    // a cada conexão aceita pelo servidor
+    if (model == "Http")
+    {
+        serverApp.Get(0)->TraceConnectWithoutContext(
+            "ConnectionEstablished",
+            MakeBoundCallback(&ConexaoHttpTrace, server->GetId()));
+    }
+    else if (tcp)
+    {
+        Simulator::Schedule(Seconds(start + 0.001), &ConectarRastreamentoTcp, source->GetId());
+    }
+}
+
+// Instala os fluxos de um cliente nos sentidos definidos por trafficDirection. Os clientes do
+// grupo reservado para a rotatividade recebem um par de aplicações por sessão, em portas
+// deslocadas de churnPortStride, todas criadas antes da simulação.
+void
+InstalarFluxosCliente(std::string socketFactory,
+                      Ptr<Node> client,
+                      Ipv4Address clientAddress,
+                      Ptr<Node> server,
+                      Ipv4Address serverAddress,
+                      uint16_t port,
+                      uint32_t clientIndex,
+                      uint32_t groupSize,
+                      double simulationTime)
+{
+    if (trafficDirection != "Uplink" && trafficDirection != "Downlink" &&
+        trafficDirection != "Bidirectional")
+    {
+        NS_FATAL_ERROR("Sentido de tráfego desconhecido: " << trafficDirection);
+    }
+
+    std::vector<std::pair<double, double>> sessions;
+    if (churnArrivalRate > 0 && clientIndex < churnPool)
+    {
+        churnAddresses.insert(clientAddress);
+        for (const SessaoRotatividade& session : SessoesRotatividade(groupSize))
+        {
+            if (session.slot == clientIndex)
+            {
+                sessions.emplace_back(session.arrival + churnAssociationLead, session.departure);
+            }
+        }
+    }
+    else
+    {
+        sessions.emplace_back(InicioCliente(clientIndex), simulationTime);
+    }
+
+    for (std::size_t k = 0; k < sessions.size(); k++)
+    {
+        for (bool downlink : {false, true})
+        {
+            if (trafficDirection == (downlink ? "Uplink" : "Downlink"))
+            {
+                continue;
+            }
+            InstalarFluxo(socketFactory,
+                          client,
+                          clientAddress,
+                          server,
+                          serverAddress,
+                          port + k * churnPortStride,
+                          downlink,
+                          clientIndex,
+                          groupSize,
+                          sessions[k].first,
+                          sessions[k].second,
+                          simulationTime);
+        }
+    }
+}
+
+// Procura o fluxo registrado de uma 5-tupla. "data" indica se a 5-tupla carrega os dados do
+// fluxo ou apenas o caminho de volta (ACKs do TCP, pedidos HTTP).
+const FlowInfo*
+BuscarFluxo(const Ipv4FlowClassifier::FiveTuple& t, bool& data)
+{
+    auto it = registeredFlows.find({t.protocol, t.destinationAddress, t.destinationPort});
+    if (it != registeredFlows.end())
+    {
+        data = !it->second.dataFromListener;
+        return &it->second;
+    }
+    it = registeredFlows.find({t.protocol, t.sourceAddress, t.sourcePort});
+    if (it != registeredFlows.end())
+    {
+        data = it->second.dataFromListener;
+        return &it->second;
+    }
+    return nullptr;
+}
+
+// Goodput do fluxo (Mbps): bytes de aplicação sobre o tempo em que o gerador esteve ligado, na
+// mesma base da carga oferecida. Os ACKs do TCP e os pedidos HTTP usam o tempo do fluxo de
+// dados; fluxos não registrados, a simulação inteira.
+double
+GoodputFluxo(const Ipv4FlowClassifier::FiveTuple& t,
+             const FlowMonitor::FlowStats& flowStats,
+             double simulationTime)
+{
+    bool data = false;
+    const FlowInfo* info = BuscarFluxo(t, data);
+    double activeTime = info ? info->stopTime - info->startTime : simulationTime;
+    return BytesAplicacao(t.protocol, flowStats.rxBytes, flowStats.rxPackets) * 8.0 / activeTime /
+           1e6;
+}
+
+// Goodput e atraso médio dos fluxos de dados agregados por sentido e modelo de tráfego
+void
+ImprimirRelatorioTrafego(const std::map<FlowId, FlowMonitor::FlowStats>& stats,
+                         Ptr<Ipv4FlowClassifier> classifier,
+                         double simulationTime)
+{
+    struct ModelStats
+    {
+        uint32_t flows = 0;
+        double goodput = 0;
+        double delaySum = 0;
+        uint64_t rxPackets = 0;
+    };
+
+    std::map<std::pair<std::string, std::string>, ModelStats> models;
+    for (const auto& flow : stats)
+    {
+        Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(flow.first);
+        bool data = false;
+        const FlowInfo* info = BuscarFluxo(t, data);
+        if (!info || !data)
+        {
+            continue;
+        }
+
+        ModelStats& model = models[{info->direction, info->model}];
+        model.flows++;
+        model.goodput += GoodputFluxo(t, flow.second, simulationTime);
+        model.delaySum += flow.second.delaySum.GetSeconds();
+        model.rxPackets += flow.second.rxPackets;
+    }
+
+    std::cout << "\t\t\t|================= Tráfego por sentido e modelo (" << trafficMix
+              << ") =================|\n";
+    std::cout << "Sentido\t\tModelo\tFluxos\tGoodput (Mbps)\tAtraso médio (ms)\n";
+    for (const auto& model : models)
+    {
+        double averageDelayMs =
+            model.second.rxPackets ? model.second.delaySum / model.second.rxPackets * 1000 : 0;
+        std::cout << model.first.first << "\t" << (model.first.first == "Uplink" ? "\t" : "")
+                  << model.first.second << "\t" << model.second.flows << "\t" << std::setw(5)
+                  << model.second.goodput << "\t\t" << std::setw(5) << averageDelayMs << "\n";
+    }
+}
+
+// Índice de justiça de Jain: 1 quando todos os valores são iguais, 1/n quando um só leva tudo
+double
+IndiceJain(const std::vector<double>& values)
+{
+    double sum = 0;
+    double squares = 0;
+    for (double value : values)
+    {
+        sum += value;
+        squares += value * value;
+    }
+    return squares > 0 ? sum * sum / (values.size() * squares) : 0;
+}
+
+// Alocação max-min justa de uma capacidade entre demandas (infinito = fluxo elástico)
+std::vector<double>
+AlocacaoMaxMin(const std::vector<double>& demands, double capacity)
+{
+    std::vector<std::size_t> order(demands.size());
+    for (std::size_t i = 0; i < order.size(); i++)
+    {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return demands[a] < demands[b];
+    });
+
+    std::vector<double> allocation(demands.size(), 0);
+    double remaining = capacity;
+    for (std::size_t k = 0; k < order.size(); k++)
+    {
+        double share = remaining / (order.size() - k);
+        allocation[order[k]] = std::min(demands[order[k]], share);
+        remaining -= allocation[order[k]];
+    }
+    return allocation;
+}
+
+// Relatório por classe (protocolo e sentido) dos fluxos de dados. Os fluxos de retorno (ACKs do
+// TCP, pedidos HTTP) são atribuídos ao fluxo de dados correspondente como sobrecarga. A justiça de
+// Jain usa o goodput normalizado pela carga oferecida, ou pela parcela max-min no caso dos fluxos
+// elásticos, pois os modelos de tráfego têm demandas diferentes. O índice de inanição compara o goodput do TCP com a sua parcela
+// max-min justa da capacidade efetivamente entregue: 0 = o TCP recebe a parcela justa, 1 = o TCP
+// não recebe nada porque o UDP, que não reage a perdas, ocupou o canal.
+void
+ImprimirRelatorioClasses(const std::map<FlowId, FlowMonitor::FlowStats>& stats,
+                         Ptr<Ipv4FlowClassifier> classifier,
+                         double simulationTime)
+{
+    struct FluxoClasse
+    {
+        uint8_t protocol;
+        std::string direction;
+        double goodput;
+        double offered;
+        uint64_t dataBytes;
+        uint64_t returnBytes = 0;
+        double fairShare = 0;
+    };
+
+    // Fluxos de dados indexados pela 5-tupla do sentido dos dados
+    std::map<Ipv4FlowClassifier::FiveTuple, FluxoClasse> flows;
+    std::vector<std::pair<Ipv4FlowClassifier::FiveTuple, uint64_t>> returnFlows;
+    for (const auto& flow : stats)
+    {
+        Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(flow.first);
+        bool data = false;
+        const FlowInfo* info = BuscarFluxo(t, data);
+        if (!info)
+        {
+            continue;
+        }
+        if (!data)
+        {
+            returnFlows.push_back({t, flow.second.rxBytes});
+            continue;
+        }
+        // Goodput em bytes de aplicação, na mesma base de offeredBps e da parcela max-min
+        flows[t] = {t.protocol,
+                    info->direction,
+                    GoodputFluxo(t, flow.second, simulationTime) * 1e6,
+                    info->offeredBps,
+                    flow.second.rxBytes};
+    }
+    for (const auto& item : returnFlows)
+    {
+        Ipv4FlowClassifier::FiveTuple reverse = item.first;
+        std::swap(reverse.sourceAddress, reverse.destinationAddress);
+        std::swap(reverse.sourcePort, reverse.destinationPort);
+        auto flow = flows.find(reverse);
+        if (flow != flows.end())
+        {
+            flow->second.returnBytes += item.second;
+        }
+    }
+    if (flows.empty())
+    {
+        return;
+    }
+
+    double totalGoodput = 0;
+    std::map<std::pair<uint8_t, std::string>, std::vector<const FluxoClasse*>> classes;
+    for (const auto& flow : flows)
+    {
+        totalGoodput += flow.second.goodput;
+        classes[{flow.second.protocol, flow.second.direction}].push_back(&flow.second);
+    }
+
+    // Parcela max-min de cada fluxo na capacidade entregue; fluxos sem carga definida (BulkSend,
+    // HTTP) são elásticos
+    std::vector<double> demands;
+    for (const auto& flow : flows)
+    {
+        bool elastic = flow.second.offered <= 0;
+        demands.push_back(elastic ? std::numeric_limits<double>::infinity() : flow.second.offered);
+    }
+    std::vector<double> fair = AlocacaoMaxMin(demands, totalGoodput);
+    std::size_t index = 0;
+    for (auto& flow : flows)
+    {
+        flow.second.fairShare = fair[index++];
+    }
+
+    // Jain sobre razões adimensionais: goodput / carga oferecida, ou goodput / parcela max-min
+    // para os fluxos elásticos
+    auto normalized = [](const FluxoClasse* flow) {
+        double reference = flow->offered > 0 ? flow->offered : flow->fairShare;
+        return reference > 0 ? flow->goodput / reference : 0;
+    };
+
+    std::cout << "\t\t\t|================= Goodput e justiça por classe =================|\n";
+    std::cout << "Classe\tSentido\t\tFluxos\tGoodput (Mbps)\tParcela (%)\tOferecido (Mbps)\t"
+                 "Jain\tRetorno (% dos dados)\n";
+    std::vector<double> allNormalized;
+    for (const auto& item : classes)
+    {
+        double goodput = 0;
+        double offered = 0;
+        uint64_t dataBytes = 0;
+        uint64_t returnBytes = 0;
+        std::vector<double> values;
+        for (const FluxoClasse* flow : item.second)
+        {
+            goodput += flow->goodput;
+            offered += flow->offered;
+            dataBytes += flow->dataBytes;
+            returnBytes += flow->returnBytes;
+            values.push_back(normalized(flow));
+            allNormalized.push_back(normalized(flow));
+        }
+        std::cout << (item.first.first == 6 ? "TCP" : "UDP") << "\t" << item.first.second << "\t"
+                  << (item.first.second == "Uplink" ? "\t" : "") << item.second.size() << "\t"
+                  << std::setw(5) << goodput / 1e6 << "\t" << std::setw(5)
+                  << (totalGoodput > 0 ? 100 * goodput / totalGoodput : 0) << "\t"
+                  << std::setw(5) << offered / 1e6 << "\t\t" << IndiceJain(values) << "\t"
+                  << (dataBytes > 0 ? 100.0 * returnBytes / dataBytes : 0) << "\n";
+    }
+    std::cout << "Jain entre todos os fluxos de dados: " << IndiceJain(allNormalized) << "\n";
+
+    // Inanição do TCP: goodput frente à parcela max-min com as demandas conhecidas
+    double tcpGoodput = 0;
+    double tcpFair = 0;
+    uint32_t tcpFlows = 0;
+    uint32_t starvedFlows = 0;
+    for (const auto& flow : flows)
+    {
+        if (flow.second.protocol != 6)
+        {
+            continue;
+        }
+        tcpFlows++;
+        tcpGoodput += flow.second.goodput;
+        tcpFair += flow.second.fairShare;
+        starvedFlows += flow.second.goodput < 0.1 * flow.second.fairShare;
+    }
+    if (tcpFlows > 0 && tcpFlows < flows.size())
+    {
+        double starvation = tcpFair > 0 ? std::max(0.0, 1 - tcpGoodput / tcpFair) : 0;
+        std::cout << "Inanição do TCP: " << starvation << " (goodput TCP " << tcpGoodput / 1e6
+                  << " Mbps de uma parcela justa de " << tcpFair / 1e6 << " Mbps; "
+                  << starvedFlows << " de " << tcpFlows
+                  << " fluxos TCP abaixo de 10% da parcela)\n";
+    }
+}
+
+// Percentil do atraso (ms) a partir do histograma agregado (início do bin -> contagem)
+double
+PercentilAtraso(const std::map<double, std::pair<double, uint64_t>>& bins,
+                uint64_t total,
+                double percentile)
+{
+    uint64_t target = std::ceil(total * percentile);
+    uint64_t accumulated = 0;
+    for (const auto& bin : bins)
+    {
+        accumulated += bin.second.second;
+        if (accumulated >= target)
+        {
+            return (bin.first + bin.second.first / 2) * 1000;
+        }
+    }
+    return 0;
+}
+
+// Bits e tempo na taxa PHY dos quadros de dados Wi-Fi, para a eficiência MAC da varredura: a
+// taxa média é a harmônica ponderada pelos bits (bits totais / tempo nas taxas de cada quadro)
+void
+TaxaPhyTrace(WifiConstPsduMap psdus, WifiTxVector txVector, double power)
+{
+    double rate = txVector.GetMode().GetDataRate(txVector);
+    for (const auto& psdu : psdus)
+    {
+        if (psdu.second->GetNMpdus() == 0 || !psdu.second->GetHeader(0).IsData())
+        {
+            continue;
+        }
+        phyDataBits += psdu.second->GetSize() * 8;
+        phyDataTime += psdu.second->GetSize() * 8.0 / rate;
+    }
+}
+
+void
+ConectarTaxaPhy()
+{
+    if (!loadSweep)
+    {
+        return;
+    }
+    Config::ConnectWithoutContext(
+        "/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyTxPsduBegin",
+        MakeCallback(&TaxaPhyTrace));
+}
+
+void
+ColisaoTxTrace(WifiConstPsduMap psdus, WifiTxVector txVector, double power)
+{
+    for (const auto& psdu : psdus)
+    {
+        if (psdu.second->GetNMpdus() == 0)
+        {
+            continue;
+        }
+        const WifiMacHeader& header = psdu.second->GetHeader(0);
+        collisions.dataTx += header.IsData();
+        collisions.rtsTx += header.IsRts();
+    }
+}
+
+void
+ColisaoDadosTrace(Mac48Address address)
+{
+    collisions.dataFailed++;
+}
+
+void
+ColisaoRtsTrace(Mac48Address address)
+{
+    collisions.rtsFailed++;
+}
+
+void
+ColisaoRxErroTrace(Ptr<const Packet> packet, double snr)
+{
+    collisions.apRxErrors++;
+}
+
+// Conecta a contagem de transmissões e falhas de dados e RTS em todas as estações e os erros de
+// recepção no AP
+void
+ConectarColisoes()
+{
+    if (!collisionStats && !rtsCompare)
+    {
+        return;
+    }
+    std::string devices = "/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/";
+    Config::ConnectWithoutContext(devices + "Phy/PhyTxPsduBegin", MakeCallback(&ColisaoTxTrace));
+    Config::ConnectWithoutContext(devices + "RemoteStationManager/MacTxDataFailed",
+                                  MakeCallback(&ColisaoDadosTrace));
+    Config::ConnectWithoutContext(devices + "RemoteStationManager/MacTxRtsFailed",
+                                  MakeCallback(&ColisaoRtsTrace));
+    for (uint32_t i = 0; i < NodeList::GetNNodes(); i++)
+    {
+        Ptr<Node> node = NodeList::GetNode(i);
+        for (uint32_t j = 0; j < node->GetNDevices(); j++)
+        {
+            Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice>(node->GetDevice(j));
+            if (device && DynamicCast<ApWifiMac>(device->GetMac()))
+            {
+                device->GetPhy()->GetState()->TraceConnectWithoutContext(
+                    "RxError",
+                    MakeCallback(&ColisaoRxErroTrace));
+            }
+        }
+    }
+}
+
+// Colisões da execução: transmissões de dados sem ACK e RTS sem CTS
+void
+ImprimirColisoes()
+{
+    if (!collisionStats && !rtsCompare)
+    {
+        return;
+    }
+    std::cout << "\n\t\t\t|========= Colisões (" << clientTopology << ", RTS/CTS a partir de "
+              << rtsThreshold << " bytes) =========|\n";
+    std::cout << "Quadros de dados: " << collisions.dataTx << " transmissões, "
+              << collisions.dataFailed << " sem ACK (" << lastRun.collisionPercent << "%)\n";
+    std::cout << "RTS: " << collisions.rtsTx << " transmitidos, " << collisions.rtsFailed
+              << " sem CTS ("
+              << (collisions.rtsTx ? 100.0 * collisions.rtsFailed / collisions.rtsTx : 0)
+              << "%)\n";
+    std::cout << "Recepções corrompidas no AP: " << collisions.apRxErrors << "\n";
+}
+
+// Resume a execução (carga, goodput, perda e atraso dos fluxos de dados) para a busca de capacidade
+void
+CalcularResumo(const std::map<FlowId, FlowMonitor::FlowStats>& stats,
+               Ptr<Ipv4FlowClassifier> classifier,
+               double simulationTime)
+{
+    ResumoExecucao summary;
+    summary.minGoodputRatio = 100;
+    uint64_t lostPackets = 0;
+    uint64_t rxPackets = 0;
+    double delaySum = 0;
+    std::map<double, std::pair<double, uint64_t>> bins;
+    uint64_t total = 0;
+
+    for (const auto& flow : stats)
+    {
+        Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(flow.first);
+        bool data = false;
+        const FlowInfo* info = BuscarFluxo(t, data);
+        if (!info || !data)
+        {
+            continue;
+        }
+
+        // Goodput e carga em bytes de aplicação: offeredBps é a taxa do gerador, sem cabeçalhos
+        double activeTime = info->stopTime - info->startTime;
+        double goodput = GoodputFluxo(t, flow.second, simulationTime) * 1e6;
+        double offered = info->offeredBps > 0
+                             ? info->offeredBps
+                             : BytesAplicacao(t.protocol,
+                                              flow.second.txBytes,
+                                              flow.second.txPackets) *
+                                   8.0 / activeTime;
+        summary.flows++;
+        summary.offeredMbps += offered / 1e6;
+        summary.goodputMbps += goodput / 1e6;
+        if (offered > 0)
+        {
+            summary.minGoodputRatio = std::min(summary.minGoodputRatio, 100 * goodput / offered);
+        }
+        lostPackets += flow.second.lostPackets;
+        rxPackets += flow.second.rxPackets;
+        delaySum += flow.second.delaySum.GetSeconds();
+
+        const Histogram& histogram = flow.second.delayHistogram;
+        for (uint32_t i = 0; i < histogram.GetNBins(); i++)
+        {
+            auto& bin = bins[histogram.GetBinStart(i)];
+            bin.first = histogram.GetBinWidth(i);
+            bin.second += histogram.GetBinCount(i);
+            total += histogram.GetBinCount(i);
+        }
+    }
+
+    summary.lossPercent =
+        lostPackets + rxPackets ? 100.0 * lostPackets / (lostPackets + rxPackets) : 0;
+    summary.p99DelayMs = total ? PercentilAtraso(bins, total, 0.99) : 0;
+    summary.meanDelayMs = rxPackets ? delaySum / rxPackets * 1000 : 0;
+    summary.phyRateMbps = phyDataTime > 0 ? phyDataBits / phyDataTime / 1e6 : 0;
+    summary.collisionPercent =
+        collisions.dataTx ? 100.0 * collisions.dataFailed / collisions.dataTx : 0;
+    lastRun = summary;
+}
+
+#ifdef HAVE_SQLITE3
+sqlite3* database = nullptr; // Conexão com o banco de resultados, aberta na primeira gravação
+
+// Executa um comando SQL sem resultados, abortando a simulação em caso de erro
+void
+ExecutarSql(const std::string& sql)
+{
+    char* error = nullptr;
+    if (sqlite3_exec(database, sql.c_str(), nullptr, nullptr, &error) != SQLITE_OK)
+    {
+        std::string message = error ? error : "";
+        sqlite3_free(error);
+        NS_FATAL_ERROR("SQLite: " << message << " em " << sql);
+    }
+}
+
+sqlite3_stmt*
+PrepararSql(const std::string& sql)
+{
+    sqlite3_stmt* statement = nullptr;
+    if (sqlite3_prepare_v2(database, sql.c_str(), -1, &statement, nullptr) != SQLITE_OK)
+    {
+        NS_FATAL_ERROR("SQLite: " << sqlite3_errmsg(database) << " em " << sql);
+    }
+    return statement;
+}
+
+void
+PassoSql(sqlite3_stmt* statement)
+{
+    if (sqlite3_step(statement) != SQLITE_DONE)
+    {
+        NS_FATAL_ERROR("SQLite: " << sqlite3_errmsg(database));
+    }
+    sqlite3_reset(statement);
+    sqlite3_clear_bindings(statement);
+}
+
+// Abre o banco em modo WAL, que permite vários processos gravando o mesmo arquivo; a espera
+// por bloqueio evita falhas quando duas execuções fazem commit ao mesmo tempo
+void
+AbrirBanco()
+{
+    if (sqlite3_open(resultsDb.c_str(), &database) != SQLITE_OK)
+    {
+        NS_FATAL_ERROR("SQLite: não foi possível abrir " << resultsDb);
+    }
+    sqlite3_busy_timeout(database, 60000);
+    ExecutarSql("PRAGMA journal_mode=WAL;");
+    ExecutarSql("PRAGMA synchronous=NORMAL;");
+    ExecutarSql("CREATE TABLE IF NOT EXISTS runs ("
+                "run_id INTEGER PRIMARY KEY AUTOINCREMENT, config_key TEXT, scenario INTEGER, "
+                "n_clients INTEGER, seed INTEGER, run INTEGER, tcp_variant TEXT, queue_disc TEXT, "
+                "traffic_mix TEXT, traffic_direction TEXT, output_dir TEXT, offered_mbps REAL, "
+                "goodput_mbps REAL, loss_percent REAL, p99_delay_ms REAL, "
+                "min_goodput_ratio REAL, flows INTEGER, "
+                "created_at TEXT DEFAULT CURRENT_TIMESTAMP);");
+    ExecutarSql("CREATE TABLE IF NOT EXISTS flows ("
+                "run_id INTEGER REFERENCES runs(run_id), flow_id INTEGER, protocol INTEGER, "
+                "src_addr TEXT, src_port INTEGER, dst_addr TEXT, dst_port INTEGER, model TEXT, "
+                "direction TEXT, is_data INTEGER, tx_packets INTEGER, rx_packets INTEGER, "
+                "lost_packets INTEGER, tx_bytes INTEGER, rx_bytes INTEGER, goodput_mbps REAL, "
+                "mean_delay_ms REAL, mean_jitter_ms REAL, PRIMARY KEY (run_id, flow_id));");
+    ExecutarSql("CREATE INDEX IF NOT EXISTS runs_config ON runs(config_key);");
+}
+
+void
+FecharBanco()
+{
+    if (database)
+    {
+        sqlite3_close(database);
+        database = nullptr;
+    }
+}
+#endif
+
+// Grava o resumo da execução e as métricas de cada fluxo no banco SQLite, em uma única transação
+void
+GravarResultadosBanco(int16_t scenario,
+                      const std::map<FlowId, FlowMonitor::FlowStats>& stats,
+                      Ptr<Ipv4FlowClassifier> classifier,
+                      double simulationTime)
+{
+    if (resultsDb.empty())
+    {
+        return;
+    }
+#ifdef HAVE_SQLITE3
+    if (!database)
+    {
+        AbrirBanco();
+    }
+
+    // BEGIN IMMEDIATE reserva a escrita logo no início e serializa os processos concorrentes
+    ExecutarSql("BEGIN IMMEDIATE;");
+
+    sqlite3_stmt* runInsert = PrepararSql(
+        "INSERT INTO runs (config_key, scenario, n_clients, seed, run, tcp_variant, queue_disc, "
+        "traffic_mix, traffic_direction, output_dir, offered_mbps, goodput_mbps, loss_percent, "
+        "p99_delay_ms, min_goodput_ratio, flows) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);");
+    sqlite3_bind_text(runInsert, 1, runKey.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(runInsert, 2, scenario);
+    sqlite3_bind_int(runInsert, 3, nClients);
+    sqlite3_bind_int64(runInsert, 4, RngSeedManager::GetSeed());
+    sqlite3_bind_int64(runInsert, 5, RngSeedManager::GetRun());
+    sqlite3_bind_text(runInsert, 6, tcpVariant.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(runInsert, 7, queueDisc.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(runInsert, 8, trafficMix.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(runInsert, 9, trafficDirection.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(runInsert, 10, runDir.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_double(runInsert, 11, lastRun.offeredMbps);
+    sqlite3_bind_double(runInsert, 12, lastRun.goodputMbps);
+    sqlite3_bind_double(runInsert, 13, lastRun.lossPercent);
+    sqlite3_bind_double(runInsert, 14, lastRun.p99DelayMs);
+    sqlite3_bind_double(runInsert, 15, lastRun.minGoodputRatio);
+    sqlite3_bind_int(runInsert, 16, lastRun.flows);
+    PassoSql(runInsert);
+    sqlite3_finalize(runInsert);
+    sqlite3_int64 runId = sqlite3_last_insert_rowid(database);
+
+    // Um único comando preparado é reaproveitado para todos os fluxos da execução
+    sqlite3_stmt* flowInsert = PrepararSql(
+        "INSERT INTO flows (run_id, flow_id, protocol, src_addr, src_port, dst_addr, dst_port, "
+        "model, direction, is_data, tx_packets, rx_packets, lost_packets, tx_bytes, rx_bytes, "
+        "goodput_mbps, mean_delay_ms, mean_jitter_ms) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);");
+    for (const auto& flow : stats)
+    {
+        Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(flow.first);
+        bool data = false;
+        const FlowInfo* info = BuscarFluxo(t, data);
+
+        std::ostringstream source;
+        std::ostringstream destination;
+        source << t.sourceAddress;
+        destination << t.destinationAddress;
+
+        const FlowMonitor::FlowStats& flowStats = flow.second;
+        double meanDelayMs =
+            flowStats.rxPackets ? flowStats.delaySum.GetSeconds() / flowStats.rxPackets * 1000 : 0;
+        double meanJitterMs = flowStats.rxPackets > 1
+                                  ? flowStats.jitterSum.GetSeconds() / (flowStats.rxPackets - 1) * 1000
+                                  : 0;
+
+        sqlite3_bind_int64(flowInsert, 1, runId);
+        sqlite3_bind_int(flowInsert, 2, flow.first);
+        sqlite3_bind_int(flowInsert, 3, t.protocol);
+        sqlite3_bind_text(flowInsert, 4, source.str().c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(flowInsert, 5, t.sourcePort);
+        sqlite3_bind_text(flowInsert, 6, destination.str().c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(flowInsert, 7, t.destinationPort);
+        if (info)
+        {
+            sqlite3_bind_text(flowInsert, 8, info->model.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(flowInsert, 9, info->direction.c_str(), -1, SQLITE_TRANSIENT);
+        }
+        sqlite3_bind_int(flowInsert, 10, data);
+        sqlite3_bind_int64(flowInsert, 11, flowStats.txPackets);
+        sqlite3_bind_int64(flowInsert, 12, flowStats.rxPackets);
+        sqlite3_bind_int64(flowInsert, 13, flowStats.lostPackets);
+        sqlite3_bind_int64(flowInsert, 14, flowStats.txBytes);
+        sqlite3_bind_int64(flowInsert, 15, flowStats.rxBytes);
+        sqlite3_bind_double(flowInsert, 16, GoodputFluxo(t, flowStats, simulationTime));
+        sqlite3_bind_double(flowInsert, 17, meanDelayMs);
+        sqlite3_bind_double(flowInsert, 18, meanJitterMs);
+        PassoSql(flowInsert);
+    }
+    sqlite3_finalize(flowInsert);
+
+    ExecutarSql("COMMIT;");
+#else
+    NS_FATAL_ERROR("resultsDb exige o ns-3 compilado com suporte a SQLite");
+#endif
+}
+
+// 5-tupla de um pacote sem o cabeçalho IP; as portas TCP e UDP ocupam os 4 primeiros bytes
+Ipv4FlowClassifier::FiveTuple
+TuplaDoPacote(const Ipv4Header& header, Ptr<const Packet> packet)
+{
+    Ipv4FlowClassifier::FiveTuple t;
+    t.sourceAddress = header.GetSource();
+    t.destinationAddress = header.GetDestination();
+    t.protocol = header.GetProtocol();
+    t.sourcePort = 0;
+    t.destinationPort = 0;
+    uint8_t ports[4];
+    if ((t.protocol == 6 || t.protocol == 17) && packet->CopyData(ports, 4) == 4)
+    {
+        t.sourcePort = uint16_t(ports[0]) << 8 | ports[1];
+        t.destinationPort = uint16_t(ports[2]) << 8 | ports[3];
+    }
+    return t;
+}
+
+void
+AtrasoEnvioTrace(const Ipv4Header& header, Ptr<const Packet> packet, uint32_t interface)
+{
+    delayLogPending[packet->GetUid()] = Simulator::Now().GetSeconds();
+}
+
+// Na entrega local casa o pacote com o envio pelo UID, que o ns-3 preserva entre as cópias feitas
+// pelos dispositivos, e grava um registro binário de tamanho fixo
+void
+AtrasoEntregaTrace(const Ipv4Header& header, Ptr<const Packet> packet, uint32_t interface)
+{
+    auto sent = delayLogPending.find(packet->GetUid());
+    if (sent == delayLogPending.end())
+    {
+        return;
+    }
+    auto flow = delayLogFlows.emplace(TuplaDoPacote(header, packet), delayLogFlows.size()).first;
+
+    RegistroAtraso record;
+    record.flow = flow->second;
+    record.size = packet->GetSize() + header.GetSerializedSize();
+    record.txTime = sent->second;
+    record.rxTime = Simulator::Now().GetSeconds();
+    std::fwrite(&record, sizeof(record), 1, delayLogFile);
+    delayLogPending.erase(sent);
+}
+
+// Abre atrasos.bin e conecta os traces de envio e entrega do IPv4 em todos os nós. Deve ser
+// chamada depois de instalada a pilha de Internet.
+void
+ConectarRegistroAtrasos()
+{
+    if (!delayLog)
+    {
+        return;
+    }
+    delayLogFile = std::fopen(Saida("atrasos.bin").c_str(), "wb");
+    if (!delayLogFile)
+    {
+        NS_FATAL_ERROR("Não foi possível criar " << Saida("atrasos.bin"));
+    }
+    std::setvbuf(delayLogFile, nullptr, _IOFBF, 1 << 20);
+
+    // Cabeçalho: identificador e tamanho do registro, para o leitor validar o formato
+    const char magic[8] = {'A', 'T', 'R', 'A', 'S', 'O', 'S', '1'};
+    uint32_t recordSize = sizeof(RegistroAtraso);
+    uint32_t reserved = 0;
+    std::fwrite(magic, sizeof(magic), 1, delayLogFile);
+    std::fwrite(&recordSize, sizeof(recordSize), 1, delayLogFile);
+    std::fwrite(&reserved, sizeof(reserved), 1, delayLogFile);
+
+    Config::ConnectWithoutContext("/NodeList/*/$ns3::Ipv4L3Protocol/SendOutgoing",
+                                  MakeCallback(&AtrasoEnvioTrace));
+    Config::ConnectWithoutContext("/NodeList/*/$ns3::Ipv4L3Protocol/LocalDeliver",
+                                  MakeCallback(&AtrasoEntregaTrace));
+}
+
+// Fecha atrasos.bin e grava a tabela de fluxos (índice -> 5-tupla) em atrasos-fluxos.csv
+void
+FecharRegistroAtrasos()
+{
+    if (!delayLogFile)
+    {
+        return;
+    }
+    std::fclose(delayLogFile);
+    delayLogFile = nullptr;
+
+    std::ofstream index(Saida("atrasos-fluxos.csv"));
+    index << "flow,protocol,source,sourcePort,destination,destinationPort,data\n";
+    for (const auto& flow : delayLogFlows)
+    {
+        const Ipv4FlowClassifier::FiveTuple& t = flow.first;
+        bool data = false;
+        BuscarFluxo(t, data);
+        index << flow.second << "," << unsigned(t.protocol) << "," << t.sourceAddress << ","
+              << t.sourcePort << "," << t.destinationAddress << "," << t.destinationPort << ","
+              << data << "\n";
+    }
+    delayLogPending.clear();
+    delayLogFlows.clear();
+}
+
+// Decide se o pacote entra na amostra 1-em-rate a partir do UID, preservado pelo ns-3 em todo o
+// caminho. Todos os pontos de medição chegam à mesma decisão sem guardar estado para os pacotes
+// não amostrados; o hash evita que a amostra acompanhe padrões periódicos dos UIDs (ex.: dado e
+// ACK alternados).
+bool
+PacoteAmostrado(uint64_t uid, uint32_t rate)
+{
+    return ((uid * 0x9e3779b97f4a7c15ULL) >> 32) % rate == 0;
+}
+
+void
+AmostraEnvioTrace(const Ipv4Header& header, Ptr<const Packet> packet, uint32_t interface)
+{
+    if (!PacoteAmostrado(packet->GetUid(), flowSampling))
+    {
+        return;
+    }
+    uint32_t flowId;
+    uint32_t packetId;
+    if (!sampledClassifier->Classify(header, packet, &flowId, &packetId))
+    {
+        return;
+    }
+    if (sampledFlows.size() <= flowId)
+    {
+        sampledFlows.resize(flowId + 1);
+    }
+
+    double now = Simulator::Now().GetSeconds();
+    ContadoresAmostrados& flow = sampledFlows[flowId];
+    if (flow.txPackets == 0)
+    {
+        flow.firstTx = now;
+    }
+    flow.lastTx = now;
+    flow.txPackets++;
+    flow.txBytes += packet->GetSize() + header.GetSerializedSize();
+    sampledInFlight[packet->GetUid()] = {flowId, now};
+    sampledPeakInFlight = std::max(sampledPeakInFlight, sampledInFlight.size());
+}
+
+void
+AmostraEntregaTrace(const Ipv4Header& header, Ptr<const Packet> packet, uint32_t interface)
+{
+    if (!PacoteAmostrado(packet->GetUid(), flowSampling))
+    {
+        return;
+    }
+    auto sent = sampledInFlight.find(packet->GetUid());
+    if (sent == sampledInFlight.end())
+    {
+        return;
+    }
+
+    double now = Simulator::Now().GetSeconds();
+    double delay = now - sent->second.second;
+    ContadoresAmostrados& flow = sampledFlows[sent->second.first];
+    sampledInFlight.erase(sent);
+    if (flow.rxPackets == 0)
+    {
+        flow.firstRx = now;
+    }
+    flow.lastRx = now;
+    flow.rxPackets++;
+    uint32_t bytes = packet->GetSize() + header.GetSerializedSize();
+    flow.rxBytes += bytes;
+    flow.rxBytesSquares += double(bytes) * bytes;
+    flow.delaySum += delay;
+    flow.delaySquares += delay * delay;
+    if (flow.lastDelay >= 0)
+    {
+        flow.jitterSum += std::fabs(delay - flow.lastDelay);
+    }
+    flow.lastDelay = delay;
+    uint32_t bin = delay * 1000;
+    if (bin < sampledDelayBins)
+    {
+        flow.delayBins[bin]++;
+    }
+    else
+    {
+        flow.delayOverflow++;
+        flow.delayOverflowSum += delay;
+    }
+}
+
+// Monitor de fluxos com amostragem 1-em-N: conecta apenas os traces de envio e entrega do IPv4,
+// sem as sondas por nó do FlowMonitor, e mantém contadores de tamanho fixo por fluxo
+void
+ConectarMonitorAmostrado()
+{
+    sampledClassifier = Create<Ipv4FlowClassifier>();
+    Config::ConnectWithoutContext("/NodeList/*/$ns3::Ipv4L3Protocol/SendOutgoing",
+                                  MakeCallback(&AmostraEnvioTrace));
+    Config::ConnectWithoutContext("/NodeList/*/$ns3::Ipv4L3Protocol/LocalDeliver",
+                                  MakeCallback(&AmostraEntregaTrace));
+}
+
+// Instala o FlowMonitor completo ou, com flowSampling > 1, o monitor amostrado (retorna nulo)
+Ptr<FlowMonitor>
+InstalarMonitor(FlowMonitorHelper& helper)
+{
+    if (flowSampling > 1)
+    {
+        ConectarMonitorAmostrado();
+        return nullptr;
+    }
+    return helper.InstallAll();
+}
+
+// Converte os contadores amostrados em estimativas no formato do FlowMonitor, para que os
+// relatórios continuem valendo, e grava as estimativas com intervalos de confiança de 95% em
+// fluxos-amostrados.csv. Contagens e somas são multiplicadas por N; como cada pacote entra na
+// amostra com probabilidade 1/N, a variância da contagem estimada é (N - 1) vezes a estimativa.
+// O histograma de atraso guarda só as amostras, o que preserva os percentis. Ao fim da execução,
+// os pacotes ainda em trânsito contam como perdidos quando passaram de sampledLossTimeout ou
+// quando o gerador do fluxo já parou, pois nesse caso não há mais tempo para a entrega.
+std::map<FlowId, FlowMonitor::FlowStats>
+EstatisticasAmostradas()
+{
+    double now = Simulator::Now().GetSeconds();
+    for (const auto& packet : sampledInFlight)
+    {
+        bool data = false;
+        const FlowInfo* info = BuscarFluxo(sampledClassifier->FindFlow(packet.second.first), data);
+        bool stopped = info && info->stopTime < now;
+        if (stopped || now - packet.second.second > sampledLossTimeout)
+        {
+            sampledFlows[packet.second.first].lostPackets++;
+        }
+    }
+
+    const double n = flowSampling;
+    const double z = 1.96;
+    std::map<FlowId, FlowMonitor::FlowStats> stats;
+    std::ofstream estimates(Saida("fluxos-amostrados.csv"));
+    estimates << "flow,protocol,source,sourcePort,destination,destinationPort,sampledTx,sampledRx,"
+                 "txPackets,txPacketsCi,rxPackets,rxPacketsCi,rxBytes,rxBytesCi,meanDelayMs,"
+                 "meanDelayMsCi,lossPercent,lossPercentCi\n";
+    uint64_t sampledTx = 0;
+
+    for (FlowId id = 0; id < sampledFlows.size(); id++)
+    {
+        const ContadoresAmostrados& flow = sampledFlows[id];
+        if (flow.txPackets == 0)
+        {
+            continue;
+        }
+        sampledTx += flow.txPackets;
+
+        FlowMonitor::FlowStats& estimate = stats[id];
+        estimate.timeFirstTxPacket = Seconds(flow.firstTx);
+        estimate.timeLastTxPacket = Seconds(flow.lastTx);
+        estimate.timeFirstRxPacket = Seconds(flow.firstRx);
+        estimate.timeLastRxPacket = Seconds(flow.lastRx);
+        estimate.txPackets = flow.txPackets * n;
+        estimate.rxPackets = flow.rxPackets * n;
+        estimate.lostPackets = flow.lostPackets * n;
+        estimate.txBytes = flow.txBytes * n;
+        estimate.rxBytes = flow.rxBytes * n;
+        estimate.delaySum = Seconds(flow.delaySum * n);
+        estimate.jitterSum = Seconds(flow.jitterSum * n);
+        estimate.lastDelay = Seconds(std::max(0.0, flow.lastDelay));
+        estimate.timesForwarded = 0;
+        estimate.delayHistogram.SetDefaultBinWidth(0.001);
+        for (uint32_t bin = 0; bin < sampledDelayBins; bin++)
+        {
+            for (uint32_t i = 0; i < flow.delayBins[bin]; i++)
+            {
+                estimate.delayHistogram.AddValue((bin + 0.5) / 1000);
+            }
+        }
+        for (uint32_t i = 0; i < flow.delayOverflow; i++)
+        {
+            estimate.delayHistogram.AddValue(flow.delayOverflowSum / flow.delayOverflow);
+        }
+
+        double meanDelay = flow.rxPackets ? flow.delaySum / flow.rxPackets : 0;
+        double delayVariance =
+            flow.rxPackets ? std::max(0.0, flow.delaySquares / flow.rxPackets - meanDelay * meanDelay)
+                           : 0;
+        uint32_t resolved = flow.rxPackets + flow.lostPackets;
+        double loss = resolved ? double(flow.lostPackets) / resolved : 0;
+
+        Ipv4FlowClassifier::FiveTuple t = sampledClassifier->FindFlow(id);
+        estimates << id << "," << unsigned(t.protocol) << "," << t.sourceAddress << ","
+                  << t.sourcePort << "," << t.destinationAddress << "," << t.destinationPort
+                  << "," << flow.txPackets << "," << flow.rxPackets << ","
+                  << estimate.txPackets << "," << z * std::sqrt(estimate.txPackets * (n - 1))
+                  << "," << estimate.rxPackets << ","
+                  << z * std::sqrt(estimate.rxPackets * (n - 1)) << "," << estimate.rxBytes << ","
+                  << z * std::sqrt(n * (n - 1) * flow.rxBytesSquares) << "," << meanDelay * 1000
+                  << ","
+                  << (flow.rxPackets ? z * std::sqrt(delayVariance / flow.rxPackets) * 1000 : 0)
+                  << "," << 100 * loss << ","
+                  << (resolved ? 100 * z * std::sqrt(loss * (1 - loss) / resolved) : 0) << "\n";
+    }
+
+    NS_LOG_UNCOND("Monitor amostrado 1/" << flowSampling << ": " << sampledTx
+                                         << " pacotes amostrados em " << stats.size()
+                                         << " fluxos, pico de " << sampledPeakInFlight
+                                         << " em trânsito; estimativas em "
+                                         << Saida("fluxos-amostrados.csv"));
+    return stats;
+}
+
+// Coleta as estatísticas de fluxo do monitor instalado por InstalarMonitor. O FlowMonitor
+// completo também é serializado em XML com histogramas e sondas.
+std::map<FlowId, FlowMonitor::FlowStats>
+ColetarFluxos(FlowMonitorHelper& helper,
+              Ptr<FlowMonitor> monitor,
+              const std::string& xmlFile,
+              Ptr<Ipv4FlowClassifier>& classifier)
+{
+    if (!monitor)
+    {
+        classifier = sampledClassifier;
+        return EstatisticasAmostradas();
+    }
+    monitor->CheckForLostPackets();
+    classifier = DynamicCast<Ipv4FlowClassifier>(helper.GetClassifier());
+    std::map<FlowId, FlowMonitor::FlowStats> stats = monitor->GetFlowStats();
+    monitor->SerializeToXmlFile(xmlFile, true, true);
+    return stats;
+}
+
+// Instantes do pacote amostrado em trânsito, ou nulo se não amostrado / já entregue
+CarimbosPacote*
+CarimbosDoPacote(Ptr<const Packet> packet)
+{
+    if (!PacoteAmostrado(packet->GetUid(), latencySampling))
+    {
+        return nullptr;
+    }
+    auto it = latencyInFlight.find(packet->GetUid());
+    return it == latencyInFlight.end() ? nullptr : &it->second;
+}
+
+void
+LatenciaEnvioTrace(const Ipv4Header& header, Ptr<const Packet> packet, uint32_t interface)
+{
+    if (PacoteAmostrado(packet->GetUid(), latencySampling))
+    {
+        latencyInFlight[packet->GetUid()].send = Simulator::Now().GetSeconds();
+    }
+}
+
+void
+LatenciaFilaWifiTrace(Ptr<const WifiMpdu> mpdu)
+{
+    if (CarimbosPacote* stamps = CarimbosDoPacote(mpdu->GetPacket()))
+    {
+        stamps->wifiEnqueue = Simulator::Now().GetSeconds();
+    }
+}
+
+// Início de uma transmissão Wi-Fi. A espera pelo meio de um MPDU começa quando ele chega à
+// cabeça da sua fila EDCA: no fim da transmissão de dados anterior da mesma fila ou na sua
+// chegada, o que vier depois. ACKs, CTS, beacons e os dados das outras categorias de acesso do nó
+// não contam. Isso não depende de quando o MPDU sai da WifiMacQueue, que só ocorre após o ACK.
+void
+LatenciaTxWifiTrace(std::string context, WifiConstPsduMap psdus, WifiTxVector txVector, double power)
+{
+    uint32_t nodeId = NodeIdFromContext(context);
+    double now = Simulator::Now().GetSeconds();
+    double end =
+        now + WifiPhy::CalculateTxDuration(psdus, txVector, WIFI_PHY_BAND_2_4GHZ).GetSeconds();
+
+    for (const auto& psdu : psdus)
+    {
+        for (const auto& mpdu : *psdu.second)
+        {
+            const WifiMacHeader& header = mpdu->GetHeader();
+            if (!header.HasData())
+            {
+                continue;
+            }
+            std::pair<uint32_t, AcIndex> queue = {
+                nodeId,
+                header.IsQosData() ? QosUtilsMapTidToAc(header.GetQosTid()) : AC_BE_NQOS};
+
+            CarimbosPacote* stamps = CarimbosDoPacote(mpdu->GetPacket());
+            if (stamps && stamps->wifiEnqueue >= 0)
+            {
+                if (stamps->wifiTxFirst < 0)
+                {
+                    stamps->wifiAccess = std::max(stamps->wifiEnqueue, wifiLastTxEnd[queue]);
+                    stamps->wifiTxFirst = now;
+                }
+                stamps->wifiTxEnd = end;
+            }
+            wifiLastTxEnd[queue] = end;
+        }
+    }
+}
+
+void
+LatenciaFilaP2pTrace(bool enqueue, Ptr<const Packet> packet)
+{
+    if (CarimbosPacote* stamps = CarimbosDoPacote(packet))
+    {
+        (enqueue ? stamps->p2pEnqueue : stamps->p2pDequeue) = Simulator::Now().GetSeconds();
+    }
+}
+
+void
+LatenciaTxP2pTrace(bool receive, Ptr<const Packet> packet)
+{
+    if (CarimbosPacote* stamps = CarimbosDoPacote(packet))
+    {
+        (receive ? stamps->p2pRxEnd : stamps->p2pTxEnd) = Simulator::Now().GetSeconds();
+    }
+}
+
+// Entrega no destino: decompõe o atraso total nos componentes e acumula no fluxo
+void
+LatenciaEntregaTrace(const Ipv4Header& header, Ptr<const Packet> packet, uint32_t interface)
+{
+    CarimbosPacote* stamps = CarimbosDoPacote(packet);
+    if (!stamps || stamps->send < 0)
+    {
+        return;
+    }
+    auto difference = [](double to, double from) { return to >= 0 && from >= 0 ? to - from : 0; };
+    std::array<double, 7> components{};
+    components[0] = difference(stamps->wifiAccess, stamps->wifiEnqueue);
+    components[1] = difference(stamps->wifiTxFirst, stamps->wifiAccess);
+    components[2] = difference(stamps->wifiTxEnd, stamps->wifiTxFirst);
+    components[3] = difference(stamps->p2pDequeue, stamps->p2pEnqueue);
+    components[4] = difference(stamps->p2pTxEnd, stamps->p2pDequeue);
+    components[5] = difference(stamps->p2pRxEnd, stamps->p2pTxEnd);
+    double total = Simulator::Now().GetSeconds() - stamps->send;
+    components[6] = total;
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        components[6] -= components[i];
+    }
+
+    LatenciaFluxo& flow = latencyFlows[TuplaDoPacote(header, packet)];
+    flow.samples++;
+    flow.totalSum += total;
+    for (uint32_t i = 0; i < components.size(); i++)
+    {
+        flow.componentSum[i] += components[i];
+    }
+    latencyInFlight.erase(packet->GetUid());
+}
+
+// Conecta os pontos de medição da decomposição do atraso: envio e entrega no IPv4, fila MAC e
+// início de transmissão do Wi-Fi, fila e transmissão/recepção dos dispositivos P2P
+void
+ConectarDecomposicaoLatencia()
+{
+    if (latencySampling == 0)
+    {
+        return;
+    }
+    wifiLastTxEnd.clear();
+
+    Config::ConnectWithoutContext("/NodeList/*/$ns3::Ipv4L3Protocol/SendOutgoing",
+                                  MakeCallback(&LatenciaEnvioTrace));
+    Config::ConnectWithoutContext("/NodeList/*/$ns3::Ipv4L3Protocol/LocalDeliver",
+                                  MakeCallback(&LatenciaEntregaTrace));
+
+    // Txop sem QoS e as filas EDCA, para o caso de QoS habilitado
+    for (std::string txop : {"Txop", "BE_Txop", "BK_Txop", "VI_Txop", "VO_Txop"})
+    {
+        Config::ConnectWithoutContext("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/" + txop +
+                                          "/Queue/Enqueue",
+                                      MakeCallback(&LatenciaFilaWifiTrace));
+    }
+    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/PhyTxPsduBegin",
+                    MakeCallback(&LatenciaTxWifiTrace));
+
+    std::string p2p = "/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/";
+    Config::ConnectWithoutContext(p2p + "TxQueue/Enqueue",
+                                  MakeBoundCallback(&LatenciaFilaP2pTrace, true));
+    Config::ConnectWithoutContext(p2p + "TxQueue/Dequeue",
+                                  MakeBoundCallback(&LatenciaFilaP2pTrace, false));
+    Config::ConnectWithoutContext(p2p + "PhyTxEnd", MakeBoundCallback(&LatenciaTxP2pTrace, false));
+    Config::ConnectWithoutContext(p2p + "PhyRxEnd", MakeBoundCallback(&LatenciaTxP2pTrace, true));
+}
+
+// Atraso médio por componente dos fluxos de dados; latencia-componentes.csv traz todos os fluxos
+void
+ImprimirDecomposicaoLatencia()
+{
+    if (latencySampling == 0)
+    {
+        return;
+    }
+
+    std::ofstream csv(Saida("latencia-componentes.csv"));
+    csv << "protocol,source,sourcePort,destination,destinationPort,data,samples";
+    std::cout << "\n\t\t\t|====== Decomposição do atraso (1 em " << latencySampling
+              << " pacotes, ms) ======|\n";
+    std::cout << "Fluxo\t\t\t\t\tAmostras";
+    for (const std::string& component : latencyComponents)
+    {
+        std::cout << "\t" << component;
+        csv << "," << component;
+    }
+    std::cout << "\tTotal\n";
+    csv << ",total\n";
+
+    for (const auto& item : latencyFlows)
+    {
+        const Ipv4FlowClassifier::FiveTuple& t = item.first;
+        const LatenciaFluxo& flow = item.second;
+        bool data = false;
+        BuscarFluxo(t, data);
+
+        csv << unsigned(t.protocol) << "," << t.sourceAddress << "," << t.sourcePort << ","
+            << t.destinationAddress << "," << t.destinationPort << "," << data << ","
+            << flow.samples;
+        for (double sum : flow.componentSum)
+        {
+            csv << "," << sum / flow.samples * 1000;
+        }
+        csv << "," << flow.totalSum / flow.samples * 1000 << "\n";
+
+        if (!data)
+        {
+            continue;
+        }
+        std::cout << t.sourceAddress << ":" << t.sourcePort << " -> " << t.destinationAddress
+                  << ":" << t.destinationPort << "\t" << flow.samples;
+        for (double sum : flow.componentSum)
+        {
+            std::cout << "\t" << sum / flow.samples * 1000;
+        }
+        std::cout << "\t" << flow.totalSum / flow.samples * 1000 << "\n";
+    }
+}
+
+// Conta um descarte no nó e, quando o pacote foi identificado, no fluxo
+void
+RegistrarDescarte(uint32_t nodeId, const std::string& cause, const Ipv4FlowClassifier::FiveTuple* flow)
+{
+    auto id = dropCauseIds.emplace(cause, dropCauseNames.size());
+    if (id.second)
+    {
+        dropCauseNames.push_back(cause);
+    }
+    std::vector<uint64_t>& node = dropsPerNode[nodeId];
+    node.resize(dropCauseNames.size(), 0);
+    node[id.first->second]++;
+    if (flow)
+    {
+        std::vector<uint64_t>& counters = dropsPerFlow[*flow];
+        counters.resize(dropCauseNames.size(), 0);
+        counters[id.first->second]++;
+    }
+}
+
+// 5-tupla de um pacote que começa no cabeçalho IPv4
+bool
+TuplaIpv4(Ptr<Packet> packet, Ipv4FlowClassifier::FiveTuple& t)
+{
+    Ipv4Header header;
+    if (packet->GetSize() < 20 || packet->RemoveHeader(header) == 0)
+    {
+        return false;
+    }
+    t = TuplaDoPacote(header, packet);
+    return true;
+}
+
+// 5-tupla de um MSDU Wi-Fi (LLC/SNAP + IPv4)
+bool
+TuplaMsdu(Ptr<Packet> packet, Ipv4FlowClassifier::FiveTuple& t)
+{
+    LlcSnapHeader llc;
+    if (packet->GetSize() < 8 || packet->RemoveHeader(llc) == 0 || llc.GetType() != 0x0800)
+    {
+        return false;
+    }
+    return TuplaIpv4(packet, t);
+}
+
+// Índice do dispositivo em um contexto do tipo "/NodeList/<id>/DeviceList/<id>/..."
+uint32_t
+DeviceIdFromContext(const std::string& context)
+{
+    std::size_t start = context.find("/DeviceList/") + 12;
+    std::size_t end = context.find('/', start);
+    return std::stoul(context.substr(start, end - start));
+}
+
+// Quadro perdido na PHY (preâmbulo não detectado, recepção abortada, erro de decodificação).
+// Só contam os quadros endereçados ao próprio dispositivo; os demais são apenas escutados.
+void
+DescarteQuadroWifi(const std::string& context, Ptr<const Packet> psdu, const std::string& cause)
+{
+    uint32_t nodeId = NodeIdFromContext(context);
+    Ptr<NetDevice> device = NodeList::GetNode(nodeId)->GetDevice(DeviceIdFromContext(context));
+    Ptr<Packet> copy = psdu->Copy();
+    WifiMacHeader mac;
+    if (copy->GetSize() < 10 || copy->RemoveHeader(mac) == 0 ||
+        mac.GetAddr1() != Mac48Address::ConvertFrom(device->GetAddress()))
+    {
+        return;
+    }
+    Ipv4FlowClassifier::FiveTuple t;
+    if (mac.IsData() && TuplaMsdu(copy, t))
+    {
+        RegistrarDescarte(nodeId, cause, &t);
+    }
+    else
+    {
+        RegistrarDescarte(nodeId, cause + " (controle/gerência)", nullptr);
+    }
+}
+
+void
+DescartePhyWifiTrace(std::string context, Ptr<const Packet> psdu, WifiPhyRxfailureReason reason)
+{
+    std::ostringstream cause;
+    cause << "PHY Wi-Fi: " << reason;
+    DescarteQuadroWifi(context, psdu, cause.str());
+}
+
+void
+ErroRxWifiTrace(std::string context, Ptr<const Packet> psdu, double snr)
+{
+    DescarteQuadroWifi(context, psdu, "PHY Wi-Fi: erro de decodificação (SINR)");
+}
+
+void
+DescarteMacWifiTrace(std::string context, WifiMacDropReason reason, Ptr<const WifiMpdu> mpdu)
+{
+    std::string cause;
+    switch (reason)
+    {
+    case WIFI_MAC_DROP_FAILED_ENQUEUE:
+        cause = "MAC Wi-Fi: fila cheia";
+        break;
+    case WIFI_MAC_DROP_EXPIRED_LIFETIME:
+        cause = "MAC Wi-Fi: tempo de vida expirado";
+        break;
+    case WIFI_MAC_DROP_REACHED_RETRY_LIMIT:
+        cause = "MAC Wi-Fi: limite de retransmissões";
+        break;
+    default:
+        cause = "MAC Wi-Fi: outro";
+        break;
+    }
+    Ipv4FlowClassifier::FiveTuple t;
+    bool identified = mpdu->GetHeader().IsData() && TuplaMsdu(mpdu->GetPacket()->Copy(), t);
+    RegistrarDescarte(NodeIdFromContext(context), cause, identified ? &t : nullptr);
+}
+
+// Pacote descartado pela MAC antes de entrar na fila (ex.: estação não associada)
+void
+DescarteTxMacWifiTrace(std::string context, Ptr<const Packet> packet)
+{
+    Ipv4FlowClassifier::FiveTuple t;
+    bool identified = TuplaMsdu(packet->Copy(), t);
+    RegistrarDescarte(NodeIdFromContext(context),
+                      "MAC Wi-Fi: descartado antes da fila (não associado)",
+                      identified ? &t : nullptr);
+}
 
-using namespace ns3;
+void
+DescarteQueueDiscTrace(std::string context, Ptr<const QueueDiscItem> item, const char* reason)
+{
+    Ptr<const Ipv4QueueDiscItem> ipv4 = DynamicCast<const Ipv4QueueDiscItem>(item);
+    Ipv4FlowClassifier::FiveTuple t;
+    if (ipv4)
+    {
+        t = TuplaDoPacote(ipv4->GetHeader(), ipv4->GetPacket());
+    }
+    RegistrarDescarte(NodeIdFromContext(context),
+                      std::string("Fila (qdisc): ") + reason,
+                      ipv4 ? &t : nullptr);
+}
 
-NS_LOG_COMPONENT_DEFINE("ScracthSimulator");
+// Descarte no dispositivo P2P: fila do dispositivo cheia ou modelo de erro na recepção
+void
+DescarteP2pTrace(std::string cause, std::string context, Ptr<const Packet> packet)
+{
+    Ptr<Packet> copy = packet->Copy();
+    PppHeader ppp;
+    Ipv4FlowClassifier::FiveTuple t;
+    bool identified = copy->GetSize() >= 2 && copy->RemoveHeader(ppp) > 0 &&
+                      ppp.GetProtocol() == 0x0800 && TuplaIpv4(copy, t);
+    RegistrarDescarte(NodeIdFromContext(context), cause, identified ? &t : nullptr);
+}
 
-#define SIMULATION_TIME 20.0
-#define nClients 2
+void
+DescarteIpv4Trace(std::string context,
+                  const Ipv4Header& header,
+                  Ptr<const Packet> packet,
+                  Ipv4L3Protocol::DropReason reason,
+                  Ptr<Ipv4> ipv4,
+                  uint32_t interface)
+{
+    std::string cause;
+    switch (reason)
+    {
+    case Ipv4L3Protocol::DROP_TTL_EXPIRED:
+        cause = "IPv4: TTL expirado";
+        break;
+    case Ipv4L3Protocol::DROP_NO_ROUTE:
+        cause = "IPv4: sem rota";
+        break;
+    case Ipv4L3Protocol::DROP_BAD_CHECKSUM:
+        cause = "IPv4: checksum inválido";
+        break;
+    case Ipv4L3Protocol::DROP_INTERFACE_DOWN:
+        cause = "IPv4: interface desativada";
+        break;
+    case Ipv4L3Protocol::DROP_ROUTE_ERROR:
+        cause = "IPv4: erro de rota";
+        break;
+    case Ipv4L3Protocol::DROP_FRAGMENT_TIMEOUT:
+        cause = "IPv4: fragmentos expirados";
+        break;
+    default:
+        cause = "IPv4: outro";
+        break;
+    }
+    Ipv4FlowClassifier::FiveTuple t = TuplaDoPacote(header, packet);
+    RegistrarDescarte(NodeIdFromContext(context), cause, &t);
+}
+
+// Entrada no estado de perda do TCP, que só ocorre por expiração do RTO. O socket identifica o
+// fluxo pelo endereço local e do par.
+void
+TcpCongStateTrace(const TcpSocketBase* socket,
+                  uint32_t nodeId,
+                  TcpSocketState::TcpCongState_t oldState,
+                  TcpSocketState::TcpCongState_t newState)
+{
+    if (newState != TcpSocketState::CA_LOSS || oldState == TcpSocketState::CA_LOSS)
+    {
+        return;
+    }
+    Address local;
+    Address peer;
+    Ipv4FlowClassifier::FiveTuple t;
+    bool identified = socket->GetSockName(local) == 0 && socket->GetPeerName(peer) == 0 &&
+                      InetSocketAddress::IsMatchingType(local) &&
+                      InetSocketAddress::IsMatchingType(peer);
+    if (identified)
+    {
+        t.protocol = 6;
+        t.sourceAddress = InetSocketAddress::ConvertFrom(local).GetIpv4();
+        t.sourcePort = InetSocketAddress::ConvertFrom(local).GetPort();
+        t.destinationAddress = InetSocketAddress::ConvertFrom(peer).GetIpv4();
+        t.destinationPort = InetSocketAddress::ConvertFrom(peer).GetPort();
+    }
+    RegistrarDescarte(nodeId, "TCP: timeout (RTO)", identified ? &t : nullptr);
+}
+
+// Conecta os traces de descarte de todas as camadas: PHY e MAC do Wi-Fi, filas (qdisc e
+// dispositivo P2P), modelo de erro do P2P e IPv4. Os timeouts do TCP são conectados junto
+// com os demais traces dos sockets, em ConectarRastreamentoTcp.
+void
+ConectarCausasDescarte()
+{
+    if (!dropCauses)
+    {
+        return;
+    }
+    std::string wifi = "/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/";
+    Config::Connect(wifi + "Phy/PhyRxDrop", MakeCallback(&DescartePhyWifiTrace));
+    Config::Connect(wifi + "Phy/State/RxError", MakeCallback(&ErroRxWifiTrace));
+    Config::Connect(wifi + "Mac/DroppedMpdu", MakeCallback(&DescarteMacWifiTrace));
+    Config::Connect(wifi + "Mac/MacTxDrop", MakeCallback(&DescarteTxMacWifiTrace));
+
+    std::string qdisc = "/NodeList/*/$ns3::TrafficControlLayer/RootQueueDiscList/*/";
+    Config::Connect(qdisc + "DropBeforeEnqueue", MakeCallback(&DescarteQueueDiscTrace));
+    Config::Connect(qdisc + "DropAfterDequeue", MakeCallback(&DescarteQueueDiscTrace));
+
+    std::string p2p = "/NodeList/*/DeviceList/*/$ns3::PointToPointNetDevice/";
+    Config::Connect(p2p + "TxQueue/Drop",
+                    MakeBoundCallback(&DescarteP2pTrace, std::string("Fila do dispositivo P2P cheia")));
+    Config::Connect(p2p + "PhyRxDrop",
+                    MakeBoundCallback(&DescarteP2pTrace, std::string("P2P: modelo de erro")));
+
+    Config::Connect("/NodeList/*/$ns3::Ipv4L3Protocol/Drop", MakeCallback(&DescarteIpv4Trace));
+}
+
+// Tabela compacta de descartes: totais por causa, por nó e por fluxo de dados. Descartes na PHY
+// e retransmissões são tentativas perdidas, não necessariamente pacotes perdidos. Todas as
+// contagens vão para perdas-causas.csv.
+void
+ImprimirCausasDescarte()
+{
+    if (!dropCauses)
+    {
+        return;
+    }
+    std::ofstream csv(Saida("perdas-causas.csv"));
+    csv << "scope,id,data,cause,count\n";
+
+    std::vector<uint64_t> totals(dropCauseNames.size(), 0);
+    for (const auto& node : dropsPerNode)
+    {
+        for (uint32_t i = 0; i < node.second.size(); i++)
+        {
+            totals[i] += node.second[i];
+            if (node.second[i])
+            {
+                csv << "node," << node.first << ",," << dropCauseNames[i] << ","
+                    << node.second[i] << "\n";
+            }
+        }
+    }
+
+    std::cout << "\n\t\t\t|================= Causas de descarte =================|\n";
+    std::cout << "Causa\t\t\t\t\t\tTotal\tPor nó\n";
+    for (uint32_t i = 0; i < dropCauseNames.size(); i++)
+    {
+        std::cout << std::left << std::setw(48) << dropCauseNames[i] << std::right << "\t"
+                  << totals[i] << "\t";
+        for (const auto& node : dropsPerNode)
+        {
+            if (i < node.second.size() && node.second[i])
+            {
+                std::cout << " nó " << node.first << ": " << node.second[i];
+            }
+        }
+        std::cout << "\n";
+    }
+
+    std::cout << "Fluxo de dados\t\t\t\t\tDescartes por causa\n";
+    for (const auto& flow : dropsPerFlow)
+    {
+        const Ipv4FlowClassifier::FiveTuple& t = flow.first;
+        bool data = false;
+        BuscarFluxo(t, data);
+        std::ostringstream name;
+        name << t.sourceAddress << ":" << t.sourcePort << " -> " << t.destinationAddress << ":"
+             << t.destinationPort;
+        for (uint32_t i = 0; i < flow.second.size(); i++)
+        {
+            if (flow.second[i])
+            {
+                csv << "flow," << unsigned(t.protocol) << " " << name.str() << "," << data << ","
+                    << dropCauseNames[i] << "," << flow.second[i] << "\n";
+            }
+        }
+        if (!data)
+        {
+            continue;
+        }
+        std::cout << (t.protocol == 6 ? "TCP " : "UDP ") << name.str() << "\t";
+        for (uint32_t i = 0; i < flow.second.size(); i++)
+        {
+            if (flow.second[i])
+            {
+                std::cout << " " << dropCauseNames[i] << ": " << flow.second[i] << ";";
+            }
+        }
+        std::cout << "\n";
+    }
+}
+
+void
+TelemetriaEntradaFilaTrace(Ptr<const WifiMpdu> mpdu)
+{
+    telemetryEnqueued[mpdu->GetPacket()->GetUid()] = Simulator::Now().GetSeconds();
+}
+
+// Saída da fila (após o ACK ou o descarte por retransmissões/tempo de vida): tempo de permanência
+void
+TelemetriaSaidaFilaTrace(Ptr<const WifiMpdu> mpdu)
+{
+    auto it = telemetryEnqueued.find(mpdu->GetPacket()->GetUid());
+    if (it == telemetryEnqueued.end())
+    {
+        return;
+    }
+    double sojourn = Simulator::Now().GetSeconds() - it->second;
+    telemetryEnqueued.erase(it);
+    telemetryCurrent.departures++;
+    telemetryCurrent.sojournSum += sojourn;
+    telemetryCurrent.sojournMax = std::max(telemetryCurrent.sojournMax, sojourn);
+}
+
+// Período concluído em um estado da PHY do AP, repartido entre os intervalos que atravessa
+void
+TelemetriaEstadoPhyTrace(Time start, Time duration, WifiPhyState state)
+{
+    std::vector<double>& bins = telemetryStateTime[state];
+    double time = start.GetSeconds();
+    double end = time + duration.GetSeconds();
+    while (time < end)
+    {
+        std::size_t bin = time / telemetryInterval;
+        double binEnd = std::min(end, (bin + 1) * telemetryInterval);
+        if (bins.size() <= bin)
+        {
+            bins.resize(bin + 1, 0);
+        }
+        bins[bin] += binEnd - time;
+        time = binEnd;
+    }
+}
+
+void
+AmostrarTelemetria()
+{
+    AmostraTelemetria sample = telemetryCurrent;
+    sample.time = Simulator::Now().GetSeconds();
+    sample.queuePackets = 0;
+    sample.queueBytes = 0;
+    for (const Ptr<WifiMacQueue>& queue : telemetryQueues)
+    {
+        sample.queuePackets += queue->GetNPackets();
+        sample.queueBytes += queue->GetNBytes();
+    }
+    telemetrySamples.push_back(sample);
+    telemetryCurrent = AmostraTelemetria();
+    Simulator::Schedule(Seconds(telemetryInterval), &AmostrarTelemetria);
+}
+
+// Localiza o AP pela MAC e conecta a telemetria às suas filas MAC e ao estado da sua PHY
+void
+ConectarTelemetria()
+{
+    if (telemetryInterval <= 0)
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < NodeList::GetNNodes(); i++)
+    {
+        Ptr<Node> node = NodeList::GetNode(i);
+        for (uint32_t j = 0; j < node->GetNDevices(); j++)
+        {
+            Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice>(node->GetDevice(j));
+            if (!device || !DynamicCast<ApWifiMac>(device->GetMac()))
+            {
+                continue;
+            }
+            Ptr<WifiMac> mac = device->GetMac();
+            if (mac->GetQosSupported())
+            {
+                for (AcIndex ac : {AC_BE, AC_BK, AC_VI, AC_VO})
+                {
+                    telemetryQueues.push_back(mac->GetQosTxop(ac)->GetWifiMacQueue());
+                }
+            }
+            else
+            {
+                telemetryQueues.push_back(mac->GetTxop()->GetWifiMacQueue());
+            }
+            device->GetPhy()->GetState()->TraceConnectWithoutContext(
+                "State",
+                MakeCallback(&TelemetriaEstadoPhyTrace));
+        }
+    }
+    for (const Ptr<WifiMacQueue>& queue : telemetryQueues)
+    {
+        queue->TraceConnectWithoutContext("Enqueue", MakeCallback(&TelemetriaEntradaFilaTrace));
+        queue->TraceConnectWithoutContext("Dequeue", MakeCallback(&TelemetriaSaidaFilaTrace));
+        queue->TraceConnectWithoutContext("Expired", MakeCallback(&TelemetriaSaidaFilaTrace));
+    }
+    Simulator::Schedule(Seconds(telemetryInterval), &AmostrarTelemetria);
+}
+
+// Série temporal em telemetria-ap.csv e resumo de saturação do canal: ocupação média (TX, RX e
+// CCA ocupado vistos pelo AP), fração dos intervalos acima de 90% e pico da fila
+void
+ImprimirTelemetria()
+{
+    if (telemetryInterval <= 0)
+    {
+        return;
+    }
+    auto stateTime = [](WifiPhyState state, std::size_t bin) {
+        auto it = telemetryStateTime.find(state);
+        return it != telemetryStateTime.end() && bin < it->second.size() ? it->second[bin] : 0.0;
+    };
+
+    std::ofstream csv(Saida("telemetria-ap.csv"));
+    csv << "time,queuePackets,queueBytes,departures,sojournMeanMs,sojournMaxMs,idle,ccaBusy,tx,rx,"
+           "other,utilization\n";
+    double utilizationSum = 0;
+    uint32_t saturated = 0;
+    uint32_t activeIntervals = 0;
+    uint32_t peakPackets = 0;
+    uint64_t departures = 0;
+    double sojournSum = 0;
+
+    for (std::size_t i = 0; i < telemetrySamples.size(); i++)
+    {
+        const AmostraTelemetria& sample = telemetrySamples[i];
+        double idle = stateTime(WifiPhyState::IDLE, i) / telemetryInterval;
+        double ccaBusy = stateTime(WifiPhyState::CCA_BUSY, i) / telemetryInterval;
+        double tx = stateTime(WifiPhyState::TX, i) / telemetryInterval;
+        double rx = stateTime(WifiPhyState::RX, i) / telemetryInterval;
+        double other = std::max(0.0, 1 - idle - ccaBusy - tx - rx);
+        double utilization = ccaBusy + tx + rx;
+
+        csv << sample.time << "," << sample.queuePackets << "," << sample.queueBytes << ","
+            << sample.departures << ","
+            << (sample.departures ? sample.sojournSum / sample.departures * 1000 : 0) << ","
+            << sample.sojournMax * 1000 << "," << idle << "," << ccaBusy << "," << tx << "," << rx
+            << "," << other << "," << utilization << "\n";
+
+        peakPackets = std::max(peakPackets, sample.queuePackets);
+        departures += sample.departures;
+        sojournSum += sample.sojournSum;
+        if (sample.time > InicioTrafego())
+        {
+            activeIntervals++;
+            utilizationSum += utilization;
+            saturated += utilization > 0.9;
+        }
+    }
+
+    std::cout << "\n\t\t\t|================= Telemetria do AP =================|\n";
+    std::cout << "Ocupação média do canal (%)\tIntervalos > 90% (%)\tPico da fila (pacotes)\t"
+                 "Permanência média na fila (ms)\n";
+    std::cout << (activeIntervals ? 100 * utilizationSum / activeIntervals : 0) << "\t\t\t"
+              << (activeIntervals ? 100.0 * saturated / activeIntervals : 0) << "\t\t\t"
+              << peakPackets << "\t\t\t" << (departures ? sojournSum / departures * 1000 : 0)
+              << "\n";
+}
+
+// Quadro de dados recebido com sucesso: conta os bytes, a SNR e a taxa PHY para o cliente
+// envolvido (o transmissor, quando quem recebe é o AP, ou o próprio receptor, se for estação)
+void
+MapaCalorRxTrace(std::string context,
+                 Ptr<const Packet> packet,
+                 uint16_t channelFreqMhz,
+                 WifiTxVector txVector,
+                 MpduInfo aMpdu,
+                 SignalNoiseDbm signalNoise,
+                 uint16_t staId)
+{
+    uint32_t nodeId = NodeIdFromContext(context);
+    Ptr<NetDevice> device = NodeList::GetNode(nodeId)->GetDevice(DeviceIdFromContext(context));
+    WifiMacHeader mac;
+    if (packet->PeekHeader(mac) == 0 || !mac.IsData() ||
+        mac.GetAddr1() != Mac48Address::ConvertFrom(device->GetAddress()))
+    {
+        return;
+    }
+
+    uint32_t client = nodeId;
+    if (heatmapStations.find(mac.GetAddr1()) == heatmapStations.end())
+    {
+        auto station = heatmapStations.find(mac.GetAddr2());
+        if (station == heatmapStations.end())
+        {
+            return;
+        }
+        client = station->second;
+    }
+
+    uint32_t overhead = mac.GetSerializedSize() + 4 + 8; // Cabeçalho MAC, FCS e LLC/SNAP
+    AcumuladoPosicao& current = heatmapCurrent[client];
+    current.bytes += packet->GetSize() > overhead ? packet->GetSize() - overhead : 0;
+    current.snrSum += signalNoise.signal - signalNoise.noise;
+    current.rateSum += txVector.GetMode().GetDataRate(txVector) / 1e6;
+    current.frames++;
+}
+
+// Fecha o intervalo: posição de cada cliente no instante da amostra e vazão do intervalo
+void
+AmostrarMapaCalor()
+{
+    double now = Simulator::Now().GetSeconds();
+    if (now > InicioTrafego())
+    {
+        for (const auto& station : heatmapStations)
+        {
+            Vector position =
+                NodeList::GetNode(station.second)->GetObject<MobilityModel>()->GetPosition();
+            const AcumuladoPosicao& current = heatmapCurrent[station.second];
+            double mbps = current.bytes * 8.0 / heatmapInterval / 1e6;
+
+            CelulaMapa& cell = heatmapGrid[{int32_t(std::floor(position.x / heatmapCell)),
+                                            int32_t(std::floor(position.y / heatmapCell))}];
+            cell.samples++;
+            cell.mbpsSum += mbps;
+            cell.mbpsMin = std::min(cell.mbpsMin, mbps);
+            if (current.frames)
+            {
+                cell.snrSum += current.snrSum / current.frames;
+                cell.rateSum += current.rateSum / current.frames;
+                cell.rateSamples++;
+            }
+        }
+    }
+    heatmapCurrent.clear();
+    Simulator::Schedule(Seconds(heatmapInterval), &AmostrarMapaCalor);
+}
+
+// Registra as estações (MAC -> nó) e conecta o sniffer de recepção de todas as PHYs Wi-Fi
+void
+ConectarMapaCalor()
+{
+    if (heatmapInterval <= 0)
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < NodeList::GetNNodes(); i++)
+    {
+        Ptr<Node> node = NodeList::GetNode(i);
+        for (uint32_t j = 0; j < node->GetNDevices(); j++)
+        {
+            Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice>(node->GetDevice(j));
+            if (device && DynamicCast<StaWifiMac>(device->GetMac()))
+            {
+                heatmapStations[Mac48Address::ConvertFrom(device->GetAddress())] = i;
+            }
+        }
+    }
+    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/MonitorSnifferRx",
+                    MakeCallback(&MapaCalorRxTrace));
+    Simulator::Schedule(Seconds(heatmapInterval), &AmostrarMapaCalor);
+}
+
+// Grade em mapa-calor.csv (uma linha por célula visitada) e a vazão média por célula impressa
+// como mapa, com y crescendo para cima
+void
+ImprimirMapaCalor()
+{
+    if (heatmapInterval <= 0 || heatmapGrid.empty())
+    {
+        return;
+    }
+    std::ofstream csv(Saida("mapa-calor.csv"));
+    csv << "cellX,cellY,centerX,centerY,samples,meanMbps,minMbps,meanSnrDb,meanPhyRateMbps\n";
+    int32_t minX = std::numeric_limits<int32_t>::max();
+    int32_t maxX = std::numeric_limits<int32_t>::min();
+    int32_t minY = std::numeric_limits<int32_t>::max();
+    int32_t maxY = std::numeric_limits<int32_t>::min();
+    for (const auto& item : heatmapGrid)
+    {
+        const CelulaMapa& cell = item.second;
+        csv << item.first.first << "," << item.first.second << ","
+            << (item.first.first + 0.5) * heatmapCell << ","
+            << (item.first.second + 0.5) * heatmapCell << "," << cell.samples << ","
+            << cell.mbpsSum / cell.samples << "," << cell.mbpsMin << ","
+            << (cell.rateSamples ? cell.snrSum / cell.rateSamples : 0) << ","
+            << (cell.rateSamples ? cell.rateSum / cell.rateSamples : 0) << "\n";
+        minX = std::min(minX, item.first.first);
+        maxX = std::max(maxX, item.first.first);
+        minY = std::min(minY, item.first.second);
+        maxY = std::max(maxY, item.first.second);
+    }
+
+    std::cout << "\n\t\t\t|====== Mapa de calor: vazão média por célula de " << heatmapCell
+              << " m (Mbps) ======|\n";
+    std::cout << std::setprecision(2);
+    std::cout << "y \\ x";
+    for (int32_t x = minX; x <= maxX; x++)
+    {
+        std::cout << "\t" << x * heatmapCell;
+    }
+    std::cout << "\n";
+    for (int32_t y = maxY; y >= minY; y--)
+    {
+        std::cout << y * heatmapCell;
+        for (int32_t x = minX; x <= maxX; x++)
+        {
+            auto cell = heatmapGrid.find({x, y});
+            std::cout << "\t";
+            if (cell == heatmapGrid.end())
+            {
+                std::cout << ".";
+            }
+            else
+            {
+                std::cout << cell->second.mbpsSum / cell->second.samples;
+            }
+        }
+        std::cout << "\n";
+    }
+    std::cout << std::setprecision(6);
+}
+
+// Primeira associação de cada estação
+void
+InicioAssociacaoTrace(std::string context, Mac48Address bssid)
+{
+    associationTimes.emplace(NodeIdFromContext(context), Simulator::Now().GetSeconds());
+}
+
+// Bytes entregues aos PacketSink, acumulados em intervalos de startBinWidth
+void
+InicioRxTrace(std::string context, Ptr<const Packet> packet, const Address& from)
+{
+    std::size_t bin = Simulator::Now().GetSeconds() / startBinWidth;
+    if (bin >= sinkRxBins.size())
+    {
+        sinkRxBins.resize(bin + 1, 0);
+    }
+    sinkRxBins[bin] += packet->GetSize();
+}
+
+// Conecta os registros de associação e de recepção e, fora da distribuição Fixed, escalona a
+// associação das estações com o mesmo deslocamento dos geradores, estendendo a espera por beacons
+// da varredura inicial. Com Fixed o relatório serve de referência da partida simultânea.
+void
+ConectarInicioClientes()
+{
+    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/$ns3::StaWifiMac/Assoc",
+                    MakeCallback(&InicioAssociacaoTrace));
+    Config::Connect("/NodeList/*/ApplicationList/*/$ns3::PacketSink/Rx",
+                    MakeCallback(&InicioRxTrace));
+    if (startDistribution == "Fixed")
+    {
+        return;
+    }
+    uint32_t clientIndex = 0;
+    for (uint32_t i = 0; i < NodeList::GetNNodes(); i++)
+    {
+        Ptr<Node> node = NodeList::GetNode(i);
+        for (uint32_t j = 0; j < node->GetNDevices(); j++)
+        {
+            Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice>(node->GetDevice(j));
+            Ptr<StaWifiMac> mac = device ? DynamicCast<StaWifiMac>(device->GetMac()) : nullptr;
+            if (mac)
+            {
+                TimeValue timeout;
+                mac->GetAttribute("WaitBeaconTimeout", timeout);
+                mac->SetAttribute(
+                    "WaitBeaconTimeout",
+                    TimeValue(timeout.Get() + Seconds(DeslocamentoInicio(clientIndex++))));
+            }
+        }
+    }
+}
+
+// Início de cada cliente (associação e geradores) em inicio-clientes.csv e o tempo até a carga
+// plena: primeiro intervalo em que a vazão entregue chega a 90% da menor entre a carga oferecida
+// total e a vazão média da segunda metade da simulação
+void
+ImprimirInicioClientes(double simulationTime)
+{
+    std::ofstream csv(Saida("inicio-clientes.csv"));
+    csv << "client,node,startTime,associationTime\n";
+    std::vector<double> associations;
+    uint32_t clientIndex = 0;
+    for (uint32_t i = 0; i < NodeList::GetNNodes(); i++)
+    {
+        Ptr<Node> node = NodeList::GetNode(i);
+        for (uint32_t j = 0; j < node->GetNDevices(); j++)
+        {
+            Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice>(node->GetDevice(j));
+            if (!device || !DynamicCast<StaWifiMac>(device->GetMac()))
+            {
+                continue;
+            }
+            auto association = associationTimes.find(i);
+            csv << clientIndex << "," << i << "," << InicioCliente(clientIndex) << ",";
+            if (association != associationTimes.end())
+            {
+                csv << association->second;
+                associations.push_back(association->second);
+            }
+            csv << "\n";
+            clientIndex++;
+        }
+    }
+
+    double offered = 0;
+    for (const auto& flow : registeredFlows)
+    {
+        offered += flow.second.offeredBps;
+    }
+    std::size_t half = simulationTime / 2 / startBinWidth;
+    uint64_t steadyBytes = 0;
+    for (std::size_t bin = half; bin < sinkRxBins.size(); bin++)
+    {
+        steadyBytes += sinkRxBins[bin];
+    }
+    double steady = steadyBytes * 8.0 / (simulationTime - half * startBinWidth);
+    double target = 0.9 * (offered > 0 ? std::min(offered, steady) : steady);
+    double fullLoad = -1;
+    for (std::size_t bin = InicioTrafego() / startBinWidth; bin < sinkRxBins.size(); bin++)
+    {
+        if (target > 0 && sinkRxBins[bin] * 8.0 / startBinWidth >= target)
+        {
+            fullLoad = (bin + 1) * startBinWidth - InicioTrafego();
+            break;
+        }
+    }
+
+    std::cout << "\n\t\t\t|=========== Início dos clientes (" << startDistribution << ", "
+              << startSpread << " s) ===========|\n";
+    std::cout << "Clientes associados: " << associations.size() << " de " << clientIndex << "\n";
+    if (!associations.empty())
+    {
+        std::sort(associations.begin(), associations.end());
+        std::cout << "Associação (s): primeira " << associations.front() << ", mediana "
+                  << associations[associations.size() / 2] << ", última " << associations.back()
+                  << "\n";
+    }
+    std::cout << "Vazão em regime: " << steady / 1e6 << " Mbps (oferecida: " << offered / 1e6
+              << " Mbps)\n";
+    if (fullLoad >= 0)
+    {
+        std::cout << "Tempo até a carga plena: " << fullLoad << " s após o primeiro gerador\n";
+    }
+    else
+    {
+        std::cout << "Tempo até a carga plena: não atingido\n";
+    }
+}
+
+// Envio de um pacote de dados de um fluxo existente (fora do grupo reservado)
+void
+RotatividadeEnvioTrace(const Ipv4Header& header, Ptr<const Packet> packet, uint32_t interface)
+{
+    if (churnAddresses.count(header.GetSource()) || churnAddresses.count(header.GetDestination()))
+    {
+        return;
+    }
+    bool data = false;
+    if (BuscarFluxo(TuplaDoPacote(header, packet), data) && data)
+    {
+        churnInFlight[packet->GetUid()] = Simulator::Now().GetSeconds();
+    }
+}
+
+void
+RotatividadeEntregaTrace(const Ipv4Header& header, Ptr<const Packet> packet, uint32_t interface)
+{
+    auto sent = churnInFlight.find(packet->GetUid());
+    if (sent == churnInFlight.end())
+    {
+        return;
+    }
+    churnCurrent.bytes += packet->GetSize();
+    churnCurrent.delaySum += Simulator::Now().GetSeconds() - sent->second;
+    churnCurrent.packets++;
+    churnInFlight.erase(sent);
+}
+
+// Associação e desassociação das estações do grupo reservado, atribuídas à sessão corrente
+void
+RotatividadeAssocTrace(std::string context, Mac48Address bssid)
+{
+    uint32_t nodeId = NodeIdFromContext(context);
+    auto slot = churnNodeSlot.find(nodeId);
+    if (slot == churnNodeSlot.end())
+    {
+        return;
+    }
+    churnAssociatedNodes.insert(nodeId);
+    double now = Simulator::Now().GetSeconds();
+    for (SessaoRotatividade& session : churnSessions)
+    {
+        if (session.slot == slot->second && session.arrival <= now && session.association < 0)
+        {
+            session.association = now;
+            break;
+        }
+    }
+}
+
+void
+RotatividadeDeAssocTrace(std::string context, Mac48Address bssid)
+{
+    uint32_t nodeId = NodeIdFromContext(context);
+    auto slot = churnNodeSlot.find(nodeId);
+    if (slot == churnNodeSlot.end())
+    {
+        return;
+    }
+    churnAssociatedNodes.erase(nodeId);
+    double now = Simulator::Now().GetSeconds();
+    for (SessaoRotatividade& session : churnSessions)
+    {
+        if (session.slot == slot->second && session.departure <= now &&
+            session.association >= 0 && session.disassociation < 0)
+        {
+            session.disassociation = now;
+            break;
+        }
+    }
+}
+
+// Fecha a janela da série dos fluxos existentes com o número de sessões ativas
+void
+AmostrarRotatividade()
+{
+    double now = Simulator::Now().GetSeconds();
+    churnCurrent.time = now;
+    for (const SessaoRotatividade& session : churnSessions)
+    {
+        bool running = session.arrival + churnAssociationLead <= now && now < session.departure;
+        churnCurrent.active += running;
+    }
+    churnCurrent.associated = churnAssociatedNodes.size();
+    churnBins.push_back(churnCurrent);
+    churnCurrent = JanelaRotatividade();
+    Simulator::Schedule(Seconds(churnBinWidth), &AmostrarRotatividade);
+}
+
+// Desliga o rádio das estações do grupo reservado fora das sessões: ligado na chegada, a estação
+// varre o canal e se associa; desligado após a saída, perde os beacons e se desassocia. Deve ser
+// chamada depois de instaladas as aplicações.
+void
+ConectarRotatividade()
+{
+    if (churnArrivalRate <= 0)
+    {
+        return;
+    }
+    uint32_t clientIndex = 0;
+    for (uint32_t i = 0; i < NodeList::GetNNodes() && clientIndex < churnSlots; i++)
+    {
+        Ptr<Node> node = NodeList::GetNode(i);
+        for (uint32_t j = 0; j < node->GetNDevices(); j++)
+        {
+            Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice>(node->GetDevice(j));
+            if (!device || !DynamicCast<StaWifiMac>(device->GetMac()))
+            {
+                continue;
+            }
+            uint32_t slot = clientIndex++;
+            churnNodeSlot[i] = slot;
+            Ptr<WifiPhy> phy = device->GetPhy();
+            Simulator::Schedule(Seconds(0), &WifiPhy::SetOffMode, phy);
+            for (const SessaoRotatividade& session : churnSessions)
+            {
+                if (session.slot == slot)
+                {
+                    Simulator::Schedule(Seconds(session.arrival), &WifiPhy::ResumeFromOff, phy);
+                    if (session.departure + 0.1 < SIMULATION_TIME)
+                    {
+                        Simulator::Schedule(Seconds(session.departure + 0.1),
+                                            &WifiPhy::SetOffMode,
+                                            phy);
+                    }
+                }
+            }
+            break;
+        }
+    }
+    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/$ns3::StaWifiMac/Assoc",
+                    MakeCallback(&RotatividadeAssocTrace));
+    Config::Connect("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/$ns3::StaWifiMac/DeAssoc",
+                    MakeCallback(&RotatividadeDeAssocTrace));
+    Config::ConnectWithoutContext("/NodeList/*/$ns3::Ipv4L3Protocol/SendOutgoing",
+                                  MakeCallback(&RotatividadeEnvioTrace));
+    Config::ConnectWithoutContext("/NodeList/*/$ns3::Ipv4L3Protocol/LocalDeliver",
+                                  MakeCallback(&RotatividadeEntregaTrace));
+    Simulator::Schedule(Seconds(churnBinWidth), &AmostrarRotatividade);
+}
+
+// Sessões em rotatividade-sessoes.csv, série dos fluxos existentes em rotatividade-serie.csv e o
+// efeito sobre eles: vazão agregada e atraso médio agrupados pelo número de sessões ativas
+void
+ImprimirRotatividade()
+{
+    if (churnArrivalRate <= 0)
+    {
+        return;
+    }
+    std::ofstream sessions(Saida("rotatividade-sessoes.csv"));
+    sessions << "slot,arrival,appStart,departure,association,disassociation\n";
+    std::vector<double> associationDelays;
+    for (const SessaoRotatividade& session : churnSessions)
+    {
+        sessions << session.slot << "," << session.arrival << ","
+                 << session.arrival + churnAssociationLead << "," << session.departure << ","
+                 << session.association << "," << session.disassociation << "\n";
+        if (session.association >= 0)
+        {
+            associationDelays.push_back(session.association - session.arrival);
+        }
+    }
+
+    struct NivelRotatividade
+    {
+        uint32_t bins = 0;
+        uint64_t bytes = 0;
+        double delaySum = 0;
+        uint64_t packets = 0;
+    };
+    std::map<uint32_t, NivelRotatividade> levels;
+    std::ofstream series(Saida("rotatividade-serie.csv"));
+    series << "time,activeSessions,associatedStations,existingMbps,existingDelayMs\n";
+    for (const JanelaRotatividade& bin : churnBins)
+    {
+        series << bin.time << "," << bin.active << "," << bin.associated << ","
+               << bin.bytes * 8.0 / churnBinWidth / 1e6 << ","
+               << (bin.packets ? bin.delaySum / bin.packets * 1000 : 0) << "\n";
+        if (bin.time - churnBinWidth < InicioTrafego())
+        {
+            continue;
+        }
+        NivelRotatividade& level = levels[bin.active];
+        level.bins++;
+        level.bytes += bin.bytes;
+        level.delaySum += bin.delaySum;
+        level.packets += bin.packets;
+    }
+
+    std::cout << "\n\t\t\t|=========== Rotatividade de clientes (" << churnArrivalRate
+              << " chegadas/s, sessão média de " << churnSessionMean << " s) ===========|\n";
+    std::cout << "Sessões: " << churnSessions.size() << " em " << churnSlots
+              << " estações reservadas, " << churnBlocked << " chegadas bloqueadas\n";
+    if (!associationDelays.empty())
+    {
+        std::sort(associationDelays.begin(), associationDelays.end());
+        std::cout << "Tempo de associação (s): mediana "
+                  << associationDelays[associationDelays.size() / 2] << ", máximo "
+                  << associationDelays.back() << " (" << associationDelays.size() << " de "
+                  << churnSessions.size() << " sessões associaram)\n";
+    }
+    std::cout << "Sessões ativas\tJanelas\tVazão dos existentes (Mbps)\tAtraso médio (ms)\t"
+                 "Variação da vazão (%)\n";
+    double baseline = 0;
+    for (const auto& item : levels)
+    {
+        const NivelRotatividade& level = item.second;
+        double mbps = level.bytes * 8.0 / (level.bins * churnBinWidth) / 1e6;
+        if (item.first == levels.begin()->first)
+        {
+            baseline = mbps;
+        }
+        std::cout << item.first << "\t\t" << level.bins << "\t" << mbps << "\t\t\t"
+                  << (level.packets ? level.delaySum / level.packets * 1000 : 0) << "\t\t\t"
+                  << (baseline > 0 ? 100 * (mbps - baseline) / baseline : 0) << "\n";
+    }
+}
+
+// Aplica qosEdca às MACs com QoS. O AP anuncia os mesmos parâmetros no beacon, então as
+// estações ficam com eles também depois da associação.
+void
+ConfigurarEdca()
+{
+    if (!qos || qosEdca.empty())
+    {
+        return;
+    }
+    const std::map<std::string, AcIndex> categories = {{"VO", AC_VO},
+                                                       {"VI", AC_VI},
+                                                       {"BE", AC_BE},
+                                                       {"BK", AC_BK}};
+    std::istringstream entries(qosEdca);
+    std::string entry;
+    while (std::getline(entries, entry, ';'))
+    {
+        std::size_t colon = entry.find(':');
+        auto category =
+            colon == std::string::npos ? categories.end() : categories.find(entry.substr(0, colon));
+        if (category == categories.end())
+        {
+            NS_FATAL_ERROR("Entrada inválida em qosEdca: " << entry);
+        }
+        std::vector<double> values = ListaNumeros("qosEdca", entry.substr(colon + 1));
+        if (values.size() != 4)
+        {
+            NS_FATAL_ERROR("qosEdca espera CWmin,CWmax,AIFSN,TXOP em " << entry);
+        }
+
+        for (uint32_t i = 0; i < NodeList::GetNNodes(); i++)
+        {
+            Ptr<Node> node = NodeList::GetNode(i);
+            for (uint32_t j = 0; j < node->GetNDevices(); j++)
+            {
+                Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice>(node->GetDevice(j));
+                if (!device || !device->GetMac()->GetQosSupported())
+                {
+                    continue;
+                }
+                Ptr<QosTxop> txop = device->GetMac()->GetQosTxop(category->second);
+                txop->SetMinCw(values[0]);
+                txop->SetMaxCw(values[1]);
+                txop->SetAifsn(values[2]);
+                txop->SetTxopLimit(MicroSeconds(values[3]));
+            }
+        }
+    }
+}
+
+// Vazão e atraso dos fluxos de dados por categoria de acesso, a partir da marcação de cada fluxo.
+// O orçamento de atraso é o p99 do SLA (slaMaxP99Delay).
+void
+ImprimirRelatorioQos(const std::map<FlowId, FlowMonitor::FlowStats>& stats,
+                     Ptr<Ipv4FlowClassifier> classifier)
+{
+    if (!qos)
+    {
+        return;
+    }
+    struct AcumuladoAc
+    {
+        uint32_t flows = 0;
+        double goodput = 0;
+        uint64_t rxPackets = 0;
+        uint64_t lostPackets = 0;
+        double delaySum = 0;
+        std::map<double, std::pair<double, uint64_t>> bins;
+        uint64_t total = 0;
+    };
+    std::map<AcIndex, AcumuladoAc> categories;
+    for (const auto& flow : stats)
+    {
+        Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(flow.first);
+        bool data = false;
+        const FlowInfo* info = BuscarFluxo(t, data);
+        if (!info || !data)
+        {
+            continue;
+        }
+        AcumuladoAc& category =
+            categories[QosUtilsMapTidToAc(TosDoFluxo(t.protocol == 6, info->model) >> 5)];
+        category.flows++;
+        category.goodput +=
+            BytesAplicacao(t.protocol, flow.second.rxBytes, flow.second.rxPackets) * 8.0 /
+            (info->stopTime - info->startTime);
+        category.rxPackets += flow.second.rxPackets;
+        category.lostPackets += flow.second.lostPackets;
+        category.delaySum += flow.second.delaySum.GetSeconds();
+        const Histogram& histogram = flow.second.delayHistogram;
+        for (uint32_t i = 0; i < histogram.GetNBins(); i++)
+        {
+            auto& bin = category.bins[histogram.GetBinStart(i)];
+            bin.first = histogram.GetBinWidth(i);
+            bin.second += histogram.GetBinCount(i);
+            category.total += histogram.GetBinCount(i);
+        }
+    }
+
+    std::ofstream csv(Saida("qos-categorias.csv"));
+    csv << "ac,flows,goodputMbps,meanDelayMs,p99DelayMs,lossPercent\n";
+    std::cout << "\n\t\t\t|============== QoS por categoria de acesso (EDCA) ==============|\n";
+    std::cout << "AC\tFluxos\tGoodput (Mbps)\tAtraso médio (ms)\tp99 (ms)\tPerda (%)\t"
+                 "Orçamento de "
+              << slaMaxP99Delay << " ms\n";
+    const std::vector<std::pair<AcIndex, std::string>> names = {{AC_VO, "VO"},
+                                                                {AC_VI, "VI"},
+                                                                {AC_BE, "BE"},
+                                                                {AC_BK, "BK"}};
+    for (const auto& name : names)
+    {
+        auto it = categories.find(name.first);
+        if (it == categories.end())
+        {
+            continue;
+        }
+        const AcumuladoAc& category = it->second;
+        double meanDelay = category.rxPackets ? category.delaySum / category.rxPackets * 1000 : 0;
+        double p99 = category.total ? PercentilAtraso(category.bins, category.total, 0.99) : 0;
+        uint64_t sent = category.rxPackets + category.lostPackets;
+        double loss = sent ? 100.0 * category.lostPackets / sent : 0;
+        csv << name.second << "," << category.flows << "," << category.goodput / 1e6 << ","
+            << meanDelay << "," << p99 << "," << loss << "\n";
+        std::cout << name.second << "\t" << category.flows << "\t" << std::setw(5)
+                  << category.goodput / 1e6 << "\t" << std::setw(5) << meanDelay << "\t\t\t"
+                  << std::setw(5) << p99 << "\t" << std::setw(5) << loss << "\t\t"
+                  << (p99 <= slaMaxP99Delay ? "ok" : "excedido") << "\n";
+    }
+}
+
+// Percentis de atraso dos fluxos de dados por classe de tráfego (TCP/UDP) e sentido, a partir
+// dos histogramas do FlowMonitor. Os ACKs do TCP ficam de fora.
+void
+ImprimirPercentisAtraso(const std::map<FlowId, FlowMonitor::FlowStats>& stats,
+                        Ptr<Ipv4FlowClassifier> classifier)
+{
+    std::cout << "\t\t\t|================= Atraso por classe (" << queueDisc
+              << ") =================|\n";
+    std::cout << "Classe\tSentido\t\tPacotes\t\tp50 (ms)\tp95 (ms)\tp99 (ms)\n";
+
+    for (uint8_t protocol : {6, 17})
+    {
+        for (std::string direction : {"Uplink", "Downlink"})
+        {
+            std::map<double, std::pair<double, uint64_t>> bins;
+            uint64_t total = 0;
+            for (const auto& flow : stats)
+            {
+                Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(flow.first);
+                bool data = false;
+                const FlowInfo* info = BuscarFluxo(t, data);
+                if (t.protocol != protocol || !info || !data || info->direction != direction)
+                {
+                    continue;
+                }
+                const Histogram& histogram = flow.second.delayHistogram;
+                for (uint32_t i = 0; i < histogram.GetNBins(); i++)
+                {
+                    auto& bin = bins[histogram.GetBinStart(i)];
+                    bin.first = histogram.GetBinWidth(i);
+                    bin.second += histogram.GetBinCount(i);
+                    total += histogram.GetBinCount(i);
+                }
+            }
+
+            if (total == 0)
+            {
+                continue;
+            }
+
+            std::cout << (protocol == 6 ? "TCP" : "UDP") << "\t" << direction << "\t"
+                      << (direction == "Uplink" ? "\t" : "") << total << "\t\t" << std::setw(5)
+                      << PercentilAtraso(bins, total, 0.50) << "\t" << std::setw(5)
+                      << PercentilAtraso(bins, total, 0.95) << "\t" << std::setw(5)
+                      << PercentilAtraso(bins, total, 0.99) << "\n";
+        }
+    }
+}
 
 void
 tcpNoMobility()
@@ -41,12 +3822,15 @@ tcpNoMobility()
     // Configurar o link cabeado (servidor <-> AP)
     NodeContainer p2pNodes = NodeContainer(serverNode.Get(0), apNode.Get(0));
     PointToPointHelper pointToPoint;
-    pointToPoint.SetDeviceAttribute("DataRate", StringValue("100Mbps"));
-    pointToPoint.SetChannelAttribute("Delay", StringValue("2ms"));
+    pointToPoint.SetDeviceAttribute("DataRate", StringValue(p2pDataRate));
+    pointToPoint.SetChannelAttribute("Delay", StringValue(p2pDelay));
 
     NetDeviceContainer p2pDevices;
     p2pDevices = pointToPoint.Install(p2pNodes);
 
+    // Perdas, variação de atraso e utilização do enlace cabeado
+    ConfigurarEnlaceP2P(p2pDevices);
+
     // Configurar a rede Wi-Fi
     WifiHelper wifi;
     wifi.SetStandard(WIFI_STANDARD_80211g);
@@ -100,6 +3884,9 @@ tcpNoMobility()
     MobilityServer.SetPositionAllocator(positionServer);
     MobilityServer.Install(serverNode);
 
+    // Topologia dos clientes ao redor do AP
+    PosicionarClientes(wifiClients, apNode.Get(0));
+
     // Instalar a pilha de Internet
     InternetStackHelper stack;
     stack.Install(serverNode);
@@ -118,6 +3905,9 @@ tcpNoMobility()
     Ipv4InterfaceContainer wifiInterfaces = address.Assign(clientDevices);
     address.Assign(apDevice);
 
+    // Disciplina de fila no AP e no enlace cabeado
+    InstalarFilas(apDevice, p2pDevices);
+
     // Configurar a aplicação TCP
     uint16_t port = 9;
 
@@ -125,22 +3915,16 @@ tcpNoMobility()
     {
         u_int16_t m_port = port + i;
 
-    // Cria o servidor TCP
-        PacketSinkHelper tcpServer("ns3::TcpSocketFactory", InetSocketAddress(Ipv4Address::GetAny(), m_port));
-        ApplicationContainer serverApp = tcpServer.Install(serverNode.Get(0));
-        serverApp.Start(Seconds(1.0));
-        serverApp.Stop(Seconds(simulationTime));
-
-    // Aplicação nos clientes
-        OnOffHelper onoffHelper("ns3::TcpSocketFactory", InetSocketAddress(p2pInterfaces.GetAddress(0), m_port));
-        onoffHelper.SetAttribute("DataRate", StringValue("1Mbps"));  // Taxa de dados de 1 Mbps
-        onoffHelper.SetAttribute("PacketSize", UintegerValue(1024));  // Tamanho do pacote de 1024 bytes
-        onoffHelper.SetAttribute("OnTime", StringValue("ns3::ConstantRandomVariable[Constant=1.0]"));  // Tempo de atividade 1 segundo
-        onoffHelper.SetAttribute("OffTime", StringValue("ns3::ConstantRandomVariable[Constant=0.0]")); // Tempo de inatividade 0 segundos
-    
-        ApplicationContainer clientApps = onoffHelper.Install(wifiClients.Get(i));
-        clientApps.Start(Seconds(2.0));
-        clientApps.Stop(Seconds(simulationTime));
+        // Gerador e receptor no cliente e no servidor, conforme o modelo e o sentido do tráfego
+        InstalarFluxosCliente("ns3::TcpSocketFactory",
+                              wifiClients.Get(i),
+                              wifiInterfaces.GetAddress(i),
+                              serverNode.Get(0),
+                              p2pInterfaces.GetAddress(0),
+                              m_port,
+                              i,
+                              nClients,
+                              simulationTime);
     }
 
     // Habilitar o roteamento
@@ -148,22 +3932,31 @@ tcpNoMobility()
 
     // Configurar o FlowMonitor
     FlowMonitorHelper flowmonHelper;
-    Ptr<FlowMonitor> flowMonitor = flowmonHelper.InstallAll();
+    Ptr<FlowMonitor> flowMonitor = InstalarMonitor(flowmonHelper);
+    ConectarRegistroAtrasos();
+    ConectarDecomposicaoLatencia();
+    ConectarCausasDescarte();
+    ConectarTelemetria();
+    ConectarInternosTcp();
+    ConectarMapaCalor();
+    ConectarInicioClientes();
+    ConectarRotatividade();
+    ConectarTaxaPhy();
+    ConfigurarEdca();
+    ConectarColisoes();
 
     // Habilitar rastreamento
-    pointToPoint.EnablePcapAll("tcp-no-mobility");
-    phy.EnablePcap("tcp-no-mobility", apDevice.Get(0));
+    pointToPoint.EnablePcapAll(Saida("tcp-no-mobility"));
+    phy.EnablePcap(Saida("tcp-no-mobility"), apDevice.Get(0));
 
     // Rodar a simulação
     Simulator::Stop(Seconds(simulationTime));
     Simulator::Run();
 
     // Coletar métricas do FlowMonitor
-    flowMonitor->CheckForLostPackets();
-    Ptr<Ipv4FlowClassifier> classifier =
-        DynamicCast<Ipv4FlowClassifier>(flowmonHelper.GetClassifier());
-    std::map<FlowId, FlowMonitor::FlowStats> stats = flowMonitor->GetFlowStats();
-    flowMonitor->SerializeToXmlFile("TCP-No-Mobility.xml", true, true);
+    Ptr<Ipv4FlowClassifier> classifier;
+    std::map<FlowId, FlowMonitor::FlowStats> stats =
+        ColetarFluxos(flowmonHelper, flowMonitor, Saida("TCP-No-Mobility.xml"), classifier);
    
     if (stats.empty())
     {
@@ -191,13 +3984,29 @@ tcpNoMobility()
         std::cout << flow.first << "\t\t"         // Fluxo ID
                   << t.sourceAddress << "\t"      // Endereço de origem
                   << t.destinationAddress << "\t" // Endereço de destino
-                  << std::setw(5) << (flow.second.rxBytes * 8.0 / simulationTime) / 1e6
+                  << std::setw(5) << GoodputFluxo(t, flow.second, simulationTime)
                   << "\t"                                          // Taxa em Mbps, alinhada
                   << std::setw(5) << averageDelayMs << "\t"        // Atraso médio em ms, alinhado
                   << std::setw(5) << packetLossPercentage << "\n"; // Perda de pacotes, alinhada
     }
 
-    AnimationInterface anim("AnimTcpNoMobility.xml");
+    ImprimirRelatorioTcp(stats, classifier, simulationTime);
+
+    CalcularResumo(stats, classifier, simulationTime);
+    GravarResultadosBanco(0, stats, classifier, simulationTime);
+    ImprimirRelatorioTrafego(stats, classifier, simulationTime);
+    ImprimirUtilizacaoEnlaces(stats, classifier, simulationTime);
+    ImprimirPercentisAtraso(stats, classifier);
+    ImprimirRelatorioQos(stats, classifier);
+    ImprimirDecomposicaoLatencia();
+    ImprimirCausasDescarte();
+    ImprimirTelemetria();
+    ImprimirMapaCalor();
+    ImprimirInicioClientes(simulationTime);
+    ImprimirRotatividade();
+    ImprimirColisoes();
+
+    AnimationInterface anim(Saida("AnimTcpNoMobility.xml"));
 
     anim.SetConstantPosition(serverNode.Get(0), 0, 0);
     anim.SetConstantPosition(apNode.Get(0), 40, 40);
@@ -241,12 +4050,15 @@ udpNoMobility()
     // Configurar o link cabeado (servidor <-> AP)
     NodeContainer p2pNodes = NodeContainer(serverNode.Get(0), apNode.Get(0));
     PointToPointHelper pointToPoint;
-    pointToPoint.SetDeviceAttribute("DataRate", StringValue("100Mbps"));
-    pointToPoint.SetChannelAttribute("Delay", StringValue("2ms"));
+    pointToPoint.SetDeviceAttribute("DataRate", StringValue(p2pDataRate));
+    pointToPoint.SetChannelAttribute("Delay", StringValue(p2pDelay));
 
     NetDeviceContainer p2pDevices;
     p2pDevices = pointToPoint.Install(p2pNodes);
 
+    // Perdas, variação de atraso e utilização do enlace cabeado
+    ConfigurarEnlaceP2P(p2pDevices);
+
     // Configurar a rede Wi-Fi
     WifiHelper wifi;
     wifi.SetStandard(WIFI_STANDARD_80211g);
@@ -300,6 +4112,9 @@ udpNoMobility()
     MobilityServer.SetPositionAllocator(positionServer);
     MobilityServer.Install(serverNode);
 
+    // Topologia dos clientes ao redor do AP
+    PosicionarClientes(wifiClients, apNode.Get(0));
+
     // Instalar a pilha de Internet
     InternetStackHelper stack;
     stack.Install(serverNode);
@@ -318,6 +4133,9 @@ udpNoMobility()
     Ipv4InterfaceContainer wifiInterfaces = address.Assign(clientDevices);
     address.Assign(apDevice);
 
+    // Disciplina de fila no AP e no enlace cabeado
+    InstalarFilas(apDevice, p2pDevices);
+
     // Configurar a aplicação UDP
     uint16_t port = 9;
 
@@ -325,31 +4143,16 @@ udpNoMobility()
     {
         u_int16_t m_port = port + i;
 
-        // Cria o servidor UDP
-        PacketSinkHelper udpServer("ns3::UdpSocketFactory",
-                                   InetSocketAddress(Ipv4Address::GetAny(), m_port));
-        ApplicationContainer serverApp = udpServer.Install(serverNode.Get(0));
-        serverApp.Start(Seconds(1.0));
-        serverApp.Stop(Seconds(simulationTime));
-
-        // Aplicação nos clientes
-        OnOffHelper onoffHelper("ns3::UdpSocketFactory",
-                                InetSocketAddress(p2pInterfaces.GetAddress(0), m_port));
-        onoffHelper.SetAttribute("DataRate", StringValue("1Mbps")); // Taxa de dados de 1 Mbps
-        onoffHelper.SetAttribute("PacketSize",
-                                 UintegerValue(1024)); // Tamanho do pacote de 1024 bytes
-        onoffHelper.SetAttribute(
-            "OnTime",
-            StringValue(
-                "ns3::ConstantRandomVariable[Constant=1.0]")); // Tempo de atividade 1 segundo
-        onoffHelper.SetAttribute(
-            "OffTime",
-            StringValue(
-                "ns3::ConstantRandomVariable[Constant=0.0]")); // Tempo de inatividade 0 segundos
-
-        ApplicationContainer clientApps = onoffHelper.Install(wifiClients.Get(i));
-        clientApps.Start(Seconds(2.0));
-        clientApps.Stop(Seconds(simulationTime));
+        // Gerador e receptor no cliente e no servidor, conforme o modelo e o sentido do tráfego
+        InstalarFluxosCliente("ns3::UdpSocketFactory",
+                              wifiClients.Get(i),
+                              wifiInterfaces.GetAddress(i),
+                              serverNode.Get(0),
+                              p2pInterfaces.GetAddress(0),
+                              m_port,
+                              i,
+                              nClients,
+                              simulationTime);
     }
 
     // Habilitar o roteamento
@@ -357,22 +4160,31 @@ udpNoMobility()
 
     // Configurar o FlowMonitor
     FlowMonitorHelper flowmonHelper;
-    Ptr<FlowMonitor> flowMonitor = flowmonHelper.InstallAll();
+    Ptr<FlowMonitor> flowMonitor = InstalarMonitor(flowmonHelper);
+    ConectarRegistroAtrasos();
+    ConectarDecomposicaoLatencia();
+    ConectarCausasDescarte();
+    ConectarTelemetria();
+    ConectarInternosTcp();
+    ConectarMapaCalor();
+    ConectarInicioClientes();
+    ConectarRotatividade();
+    ConectarTaxaPhy();
+    ConfigurarEdca();
+    ConectarColisoes();
 
     // Habilitar rastreamento
-    pointToPoint.EnablePcapAll("udp-no-mobility");
-    phy.EnablePcap("udp-no-mobility", apDevice.Get(0));
+    pointToPoint.EnablePcapAll(Saida("udp-no-mobility"));
+    phy.EnablePcap(Saida("udp-no-mobility"), apDevice.Get(0));
 
     // Rodar a simulação
     Simulator::Stop(Seconds(simulationTime));
     Simulator::Run();
 
     // Coletar métricas do FlowMonitor
-    flowMonitor->CheckForLostPackets();
-    Ptr<Ipv4FlowClassifier> classifier =
-        DynamicCast<Ipv4FlowClassifier>(flowmonHelper.GetClassifier());
-    std::map<FlowId, FlowMonitor::FlowStats> stats = flowMonitor->GetFlowStats();
-    flowMonitor->SerializeToXmlFile("UDP-No-Mobility.xml", true, true);
+    Ptr<Ipv4FlowClassifier> classifier;
+    std::map<FlowId, FlowMonitor::FlowStats> stats =
+        ColetarFluxos(flowmonHelper, flowMonitor, Saida("UDP-No-Mobility.xml"), classifier);
 
     if (stats.empty())
     {
@@ -400,13 +4212,27 @@ udpNoMobility()
         std::cout << flow.first << "\t\t"         // Fluxo ID
                   << t.sourceAddress << "\t"      // Endereço de origem
                   << t.destinationAddress << "\t" // Endereço de destino
-                  << std::setw(5) << (flow.second.rxBytes * 8.0 / simulationTime) / 1e6
+                  << std::setw(5) << GoodputFluxo(t, flow.second, simulationTime)
                   << "\t"                                          // Taxa em Mbps, alinhada
                   << std::setw(5) << averageDelayMs << "\t"        // Atraso médio em ms, alinhado
                   << std::setw(5) << packetLossPercentage << "\n"; // Perda de pacotes, alinhada
     }
 
-    AnimationInterface anim("AnimUdpNoMobility.xml");
+    CalcularResumo(stats, classifier, simulationTime);
+    GravarResultadosBanco(1, stats, classifier, simulationTime);
+    ImprimirRelatorioTrafego(stats, classifier, simulationTime);
+    ImprimirUtilizacaoEnlaces(stats, classifier, simulationTime);
+    ImprimirPercentisAtraso(stats, classifier);
+    ImprimirRelatorioQos(stats, classifier);
+    ImprimirDecomposicaoLatencia();
+    ImprimirCausasDescarte();
+    ImprimirTelemetria();
+    ImprimirMapaCalor();
+    ImprimirInicioClientes(simulationTime);
+    ImprimirRotatividade();
+    ImprimirColisoes();
+
+    AnimationInterface anim(Saida("AnimUdpNoMobility.xml"));
 
     anim.SetConstantPosition(serverNode.Get(0), 0, 0);
     anim.SetConstantPosition(apNode.Get(0), 40, 40);
@@ -450,12 +4276,15 @@ tcpMobility()
     // Configurar o link cabeado (servidor <-> AP)
     NodeContainer p2pNodes = NodeContainer(serverNode.Get(0), apNode.Get(0));
     PointToPointHelper pointToPoint;
-    pointToPoint.SetDeviceAttribute("DataRate", StringValue("100Mbps"));
-    pointToPoint.SetChannelAttribute("Delay", StringValue("2ms"));
+    pointToPoint.SetDeviceAttribute("DataRate", StringValue(p2pDataRate));
+    pointToPoint.SetChannelAttribute("Delay", StringValue(p2pDelay));
 
     NetDeviceContainer p2pDevices;
     p2pDevices = pointToPoint.Install(p2pNodes);
 
+    // Perdas, variação de atraso e utilização do enlace cabeado
+    ConfigurarEnlaceP2P(p2pDevices);
+
     // Configurar a rede Wi-Fi
     WifiHelper wifi;
     wifi.SetStandard(WIFI_STANDARD_80211g);
@@ -518,6 +4347,9 @@ tcpMobility()
     MobilityServer.SetPositionAllocator(positionServer);
     MobilityServer.Install(serverNode);
     
+    // Topologia dos clientes ao redor do AP
+    PosicionarClientes(wifiClients, apNode.Get(0));
+
     // Instala a pilha de Internet
     InternetStackHelper stack;
     stack.Install(serverNode);
@@ -536,50 +4368,56 @@ tcpMobility()
     Ipv4InterfaceContainer wifiInterfaces = address.Assign(clientDevices);
     address.Assign(apDevice);
 
+    // Disciplina de fila no AP e no enlace cabeado
+    InstalarFilas(apDevice, p2pDevices);
+
     // Configura o servidor TCP (usando PacketSink)
     uint16_t port = 9; // Porta TCP padrão
     for (u_int32_t i = 0; i < nClients; i++)
     {
         u_int16_t m_port = port + i;
 
-    // Cria o servidor TCP
-        PacketSinkHelper tcpServer("ns3::TcpSocketFactory", InetSocketAddress(Ipv4Address::GetAny(), m_port));
-        ApplicationContainer serverApp = tcpServer.Install(serverNode.Get(0));
-        serverApp.Start(Seconds(1.0));
-        serverApp.Stop(Seconds(simulationTime));
-
-    // Aplicação nos clientes
-        OnOffHelper onoffHelper("ns3::TcpSocketFactory", InetSocketAddress(p2pInterfaces.GetAddress(0), m_port));
-        onoffHelper.SetAttribute("DataRate", StringValue("1Mbps"));  // Taxa de dados de 1 Mbps
-        onoffHelper.SetAttribute("PacketSize", UintegerValue(1024));  // Tamanho do pacote de 1024 bytes
-        onoffHelper.SetAttribute("OnTime", StringValue("ns3::ConstantRandomVariable[Constant=1.0]"));  // Tempo de atividade 1 segundo
-        onoffHelper.SetAttribute("OffTime", StringValue("ns3::ConstantRandomVariable[Constant=0.0]")); // Tempo de inatividade 0 segundos
-    
-        ApplicationContainer clientApps = onoffHelper.Install(wifiClients.Get(i));
-        clientApps.Start(Seconds(2.0));
-        clientApps.Stop(Seconds(simulationTime));
+        // Gerador e receptor no cliente e no servidor, conforme o modelo e o sentido do tráfego
+        InstalarFluxosCliente("ns3::TcpSocketFactory",
+                              wifiClients.Get(i),
+                              wifiInterfaces.GetAddress(i),
+                              serverNode.Get(0),
+                              p2pInterfaces.GetAddress(0),
+                              m_port,
+                              i,
+                              nClients,
+                              simulationTime);
     }
     // Habilitar o roteamento
     Ipv4GlobalRoutingHelper::PopulateRoutingTables();
 
     // Habilitar rastreamento
-    pointToPoint.EnablePcapAll("tcp-mobility");
-    phy.EnablePcap("tcp-mobility", apDevice.Get(0));
+    pointToPoint.EnablePcapAll(Saida("tcp-mobility"));
+    phy.EnablePcap(Saida("tcp-mobility"), apDevice.Get(0));
 
     // Configura o FlowMonitor
     FlowMonitorHelper flowmonHelper;
-    Ptr<FlowMonitor> flowMonitor = flowmonHelper.InstallAll();
+    Ptr<FlowMonitor> flowMonitor = InstalarMonitor(flowmonHelper);
+    ConectarRegistroAtrasos();
+    ConectarDecomposicaoLatencia();
+    ConectarCausasDescarte();
+    ConectarTelemetria();
+    ConectarInternosTcp();
+    ConectarMapaCalor();
+    ConectarInicioClientes();
+    ConectarRotatividade();
+    ConectarTaxaPhy();
+    ConfigurarEdca();
+    ConectarColisoes();
 
     // Executa a simulação
     Simulator::Stop(Seconds(simulationTime));
     Simulator::Run();
 
     // Coletar métricas do FlowMonitor
-    flowMonitor->CheckForLostPackets();
-    Ptr<Ipv4FlowClassifier> classifier =
-        DynamicCast<Ipv4FlowClassifier>(flowmonHelper.GetClassifier());
-    std::map<FlowId, FlowMonitor::FlowStats> stats = flowMonitor->GetFlowStats();
-    flowMonitor->SerializeToXmlFile("TCP-Mobility.xml", true, true);
+    Ptr<Ipv4FlowClassifier> classifier;
+    std::map<FlowId, FlowMonitor::FlowStats> stats =
+        ColetarFluxos(flowmonHelper, flowMonitor, Saida("TCP-Mobility.xml"), classifier);
 
     if (stats.empty())
     {
@@ -607,13 +4445,29 @@ tcpMobility()
         std::cout << flow.first << "\t\t"         // Fluxo ID
                   << t.sourceAddress << "\t"      // Endereço de origem
                   << t.destinationAddress << "\t" // Endereço de destino
-                  << std::setw(5) << (flow.second.rxBytes * 8.0 / simulationTime) / 1e6
+                  << std::setw(5) << GoodputFluxo(t, flow.second, simulationTime)
                   << "\t"                                          // Taxa em Mbps, alinhada
                   << std::setw(5) << averageDelayMs << "\t"        // Atraso médio em ms, alinhado
                   << std::setw(5) << packetLossPercentage << "\n"; // Perda de pacotes, alinhada
     }
 
-    AnimationInterface anim("AnimTcpMobility.xml");
+    ImprimirRelatorioTcp(stats, classifier, simulationTime);
+
+    CalcularResumo(stats, classifier, simulationTime);
+    GravarResultadosBanco(2, stats, classifier, simulationTime);
+    ImprimirRelatorioTrafego(stats, classifier, simulationTime);
+    ImprimirUtilizacaoEnlaces(stats, classifier, simulationTime);
+    ImprimirPercentisAtraso(stats, classifier);
+    ImprimirRelatorioQos(stats, classifier);
+    ImprimirDecomposicaoLatencia();
+    ImprimirCausasDescarte();
+    ImprimirTelemetria();
+    ImprimirMapaCalor();
+    ImprimirInicioClientes(simulationTime);
+    ImprimirRotatividade();
+    ImprimirColisoes();
+
+    AnimationInterface anim(Saida("AnimTcpMobility.xml"));
 
     anim.SetConstantPosition(serverNode.Get(0), 0, 0);
     anim.SetConstantPosition(apNode.Get(0), 40, 40);
@@ -657,12 +4511,15 @@ udpMobility()
     // configurar o link cabeado (servidor <-> AP)
     NodeContainer p2pNodes = NodeContainer(serverNode.Get(0), apNode.Get(0));
     PointToPointHelper pointToPoint;
-    pointToPoint.SetDeviceAttribute("DataRate", StringValue("100Mbps"));
-    pointToPoint.SetChannelAttribute("Delay", StringValue("2ms"));
+    pointToPoint.SetDeviceAttribute("DataRate", StringValue(p2pDataRate));
+    pointToPoint.SetChannelAttribute("Delay", StringValue(p2pDelay));
 
     NetDeviceContainer p2pDevices;
     p2pDevices = pointToPoint.Install(p2pNodes);
 
+    // Perdas, variação de atraso e utilização do enlace cabeado
+    ConfigurarEnlaceP2P(p2pDevices);
+
     // Configura o padrão de Wi-Fi
     WifiHelper wifi;
     wifi.SetStandard(WIFI_STANDARD_80211g);
@@ -728,6 +4585,9 @@ udpMobility()
     MobilityServer.SetPositionAllocator(positionServer);
     MobilityServer.Install(serverNode);
 
+    // Topologia dos clientes ao redor do AP
+    PosicionarClientes(wifiClients, apNode.Get(0));
+
     // Instala a pilha de Internet
     InternetStackHelper stack;
     stack.Install(serverNode);
@@ -746,6 +4606,9 @@ udpMobility()
     Ipv4InterfaceContainer wifiInterfaces = address.Assign(clientDevices);
     address.Assign(apDevice);
 
+    // Disciplina de fila no AP e no enlace cabeado
+    InstalarFilas(apDevice, p2pDevices);
+
     // Configurar a aplicação UDP
     uint16_t port = 9;
 
@@ -753,44 +4616,47 @@ udpMobility()
     {
         u_int16_t m_port = port + i;
 
-        // Aplicação no servidor
-        PacketSinkHelper sinkHelper("ns3::UdpSocketFactory", InetSocketAddress(p2pInterfaces.GetAddress(0), m_port));
-        ApplicationContainer serverApp = sinkHelper.Install(serverNode.Get(0));
-        serverApp.Start(Seconds(1.0));
-        serverApp.Stop(Seconds(simulationTime));
-
-        // Aplicação nos clientes
-        OnOffHelper onoffHelper("ns3::UdpSocketFactory", InetSocketAddress(p2pInterfaces.GetAddress(0), m_port));
-        onoffHelper.SetAttribute("DataRate", StringValue("1Mbps"));  // Taxa de dados de 1 Mbps
-        onoffHelper.SetAttribute("PacketSize", UintegerValue(1024));  // Tamanho do pacote de 1024 bytes
-        onoffHelper.SetAttribute("OnTime", StringValue("ns3::ConstantRandomVariable[Constant=1.0]"));  // Tempo de atividade 1 segundo
-        onoffHelper.SetAttribute("OffTime", StringValue("ns3::ConstantRandomVariable[Constant=0.0]")); // Tempo de inatividade 0 segundos
-
-
-        ApplicationContainer clientApps = onoffHelper.Install(wifiClients.Get(i));
-        clientApps.Start(Seconds(2.0));
-        clientApps.Stop(Seconds(simulationTime));
+        // Gerador e receptor no cliente e no servidor, conforme o modelo e o sentido do tráfego
+        InstalarFluxosCliente("ns3::UdpSocketFactory",
+                              wifiClients.Get(i),
+                              wifiInterfaces.GetAddress(i),
+                              serverNode.Get(0),
+                              p2pInterfaces.GetAddress(0),
+                              m_port,
+                              i,
+                              nClients,
+                              simulationTime);
     }
     // Habilitar o roteamento
     Ipv4GlobalRoutingHelper::PopulateRoutingTables();
 
     // Habilita o rastreamento de pacotes (opcional)
-    pointToPoint.EnablePcapAll("udp-mobility");
-    phy.EnablePcap("udp-mobility", apDevice.Get(0));
+    pointToPoint.EnablePcapAll(Saida("udp-mobility"));
+    phy.EnablePcap(Saida("udp-mobility"), apDevice.Get(0));
 
     // Configura o FlowMonitor
     FlowMonitorHelper flowmonHelper;
-    Ptr<FlowMonitor> flowMonitor = flowmonHelper.InstallAll();
+    Ptr<FlowMonitor> flowMonitor = InstalarMonitor(flowmonHelper);
+    ConectarRegistroAtrasos();
+    ConectarDecomposicaoLatencia();
+    ConectarCausasDescarte();
+    ConectarTelemetria();
+    ConectarInternosTcp();
+    ConectarMapaCalor();
+    ConectarInicioClientes();
+    ConectarRotatividade();
+    ConectarTaxaPhy();
+    ConfigurarEdca();
+    ConectarColisoes();
 
     // Executa a simulação
     Simulator::Stop(Seconds(simulationTime));
     Simulator::Run();
 
     // Coletar métricas do FlowMonitor
-    flowMonitor->CheckForLostPackets();
-    Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(flowmonHelper.GetClassifier());
-    std::map<FlowId, FlowMonitor::FlowStats> stats = flowMonitor->GetFlowStats();
-    flowMonitor->SerializeToXmlFile("UDP-Mobility.xml", true, true);
+    Ptr<Ipv4FlowClassifier> classifier;
+    std::map<FlowId, FlowMonitor::FlowStats> stats =
+        ColetarFluxos(flowmonHelper, flowMonitor, Saida("UDP-Mobility.xml"), classifier);
     if (stats.empty())
     {
         NS_LOG_ERROR("Nenhum fluxo coletado.");
@@ -816,13 +4682,27 @@ udpMobility()
         std::cout << flow.first << "\t\t"         // Fluxo ID
                   << t.sourceAddress << "\t"      // Endereço de origem
                   << t.destinationAddress << "\t" // Endereço de destino
-                  << std::setw(5) << (flow.second.rxBytes * 8.0 / simulationTime) / 1e6
+                  << std::setw(5) << GoodputFluxo(t, flow.second, simulationTime)
                   << "\t"                                          // Taxa em Mbps, alinhada
                   << std::setw(5) << averageDelayMs << "\t"        // Atraso médio em ms, alinhado
                   << std::setw(5) << packetLossPercentage << "\n"; // Perda de pacotes, alinhada
     }
 
-    AnimationInterface anim("AnimUdpMobility.xml");
+    CalcularResumo(stats, classifier, simulationTime);
+    GravarResultadosBanco(3, stats, classifier, simulationTime);
+    ImprimirRelatorioTrafego(stats, classifier, simulationTime);
+    ImprimirUtilizacaoEnlaces(stats, classifier, simulationTime);
+    ImprimirPercentisAtraso(stats, classifier);
+    ImprimirRelatorioQos(stats, classifier);
+    ImprimirDecomposicaoLatencia();
+    ImprimirCausasDescarte();
+    ImprimirTelemetria();
+    ImprimirMapaCalor();
+    ImprimirInicioClientes(simulationTime);
+    ImprimirRotatividade();
+    ImprimirColisoes();
+
+    AnimationInterface anim(Saida("AnimUdpMobility.xml"));
 
     anim.SetConstantPosition(serverNode.Get(0), 0, 0);
     anim.SetConstantPosition(apNode.Get(0), 40, 40);
@@ -866,11 +4746,14 @@ tcp_udp_NoMobility()
     // Configurar o link cabeado (servidor <-> AP)
     NodeContainer p2pNodes = NodeContainer(serverNode.Get(0), apNode.Get(0));
     PointToPointHelper pointToPoint;
-    pointToPoint.SetDeviceAttribute("DataRate", StringValue("100Mbps"));
-    pointToPoint.SetChannelAttribute("Delay", StringValue("2ms"));
+    pointToPoint.SetDeviceAttribute("DataRate", StringValue(p2pDataRate));
+    pointToPoint.SetChannelAttribute("Delay", StringValue(p2pDelay));
 
     NetDeviceContainer p2pDevices = pointToPoint.Install(p2pNodes);
 
+    // Perdas, variação de atraso e utilização do enlace cabeado
+    ConfigurarEnlaceP2P(p2pDevices);
+
     // Configurar a rede Wi-Fi
     WifiHelper wifi;
     wifi.SetStandard(WIFI_STANDARD_80211g);
@@ -924,6 +4807,9 @@ tcp_udp_NoMobility()
     MobilityServer.SetPositionAllocator(positionServer);
     MobilityServer.Install(serverNode);
 
+    // Topologia dos clientes ao redor do AP
+    PosicionarClientes(wifiClients, apNode.Get(0));
+
     // Instalar a pilha de Internet
     InternetStackHelper stack;
     stack.Install(serverNode);
@@ -942,6 +4828,9 @@ tcp_udp_NoMobility()
     Ipv4InterfaceContainer wifiInterfaces = address.Assign(clientDevices);
     address.Assign(apDevice);
 
+    // Disciplina de fila no AP e no enlace cabeado
+    InstalarFilas(apDevice, p2pDevices);
+
     // Configurar aplicações
     uint16_t tcpPort = 9;  // Porta TCP
     uint16_t udpPort = nClients + 10; // Porta UDP
@@ -950,58 +4839,55 @@ tcp_udp_NoMobility()
     {
         u_int16_t m_port = udpPort + i;
 
-        // Aplicação no servidor
-        PacketSinkHelper sinkHelper("ns3::UdpSocketFactory", InetSocketAddress(p2pInterfaces.GetAddress(0), m_port));
-        ApplicationContainer serverApp = sinkHelper.Install(serverNode.Get(0));
-        serverApp.Start(Seconds(1.0));
-        serverApp.Stop(Seconds(simulationTime));
-
-        // Aplicação nos clientes
-        OnOffHelper onoffHelper("ns3::UdpSocketFactory", InetSocketAddress(p2pInterfaces.GetAddress(0), m_port));
-        onoffHelper.SetAttribute("DataRate", StringValue("1Mbps"));  // Taxa de dados de 1 Mbps
-        onoffHelper.SetAttribute("PacketSize", UintegerValue(1024));  // Tamanho do pacote de 1024 bytes
-        onoffHelper.SetAttribute("OnTime", StringValue("ns3::ConstantRandomVariable[Constant=1.0]"));  // Tempo de atividade 1 segundo
-        onoffHelper.SetAttribute("OffTime", StringValue("ns3::ConstantRandomVariable[Constant=0.0]")); // Tempo de inatividade 0 segundos
-
-
-        ApplicationContainer clientApps = onoffHelper.Install(wifiClients.Get(i));
-        clientApps.Start(Seconds(2.0));
-        clientApps.Stop(Seconds(simulationTime));
+        // Gerador e receptor no cliente e no servidor, conforme o modelo e o sentido do tráfego
+        InstalarFluxosCliente("ns3::UdpSocketFactory",
+                              wifiClients.Get(i),
+                              wifiInterfaces.GetAddress(i),
+                              serverNode.Get(0),
+                              p2pInterfaces.GetAddress(0),
+                              m_port,
+                              i,
+                              nClients/2,
+                              simulationTime);
     }
 
     for (u_int32_t i = 0; i < nClients/2; i++)
     {
         u_int16_t m_port = tcpPort + i;
 
-        // Aplicação no servidor
-        PacketSinkHelper sinkHelper("ns3::TcpSocketFactory", InetSocketAddress(p2pInterfaces.GetAddress(0), m_port));
-        ApplicationContainer serverApp = sinkHelper.Install(serverNode.Get(0));
-        serverApp.Start(Seconds(1.0));
-        serverApp.Stop(Seconds(simulationTime));
-
-        // Aplicação nos clientes
-        OnOffHelper onoffHelper("ns3::TcpSocketFactory", InetSocketAddress(p2pInterfaces.GetAddress(0), m_port));
-        onoffHelper.SetAttribute("DataRate", StringValue("1Mbps"));  // Taxa de dados de 1 Mbps
-        onoffHelper.SetAttribute("PacketSize", UintegerValue(1024));  // Tamanho do pacote de 1024 bytes
-        onoffHelper.SetAttribute("OnTime", StringValue("ns3::ConstantRandomVariable[Constant=1.0]"));  // Tempo de atividade 1 segundo
-        onoffHelper.SetAttribute("OffTime", StringValue("ns3::ConstantRandomVariable[Constant=0.0]")); // Tempo de inatividade 0 segundos
-
-
-        ApplicationContainer clientApps = onoffHelper.Install(wifiClients.Get(i));
-        clientApps.Start(Seconds(2.0));
-        clientApps.Stop(Seconds(simulationTime));
+        // Gerador e receptor no cliente e no servidor, conforme o modelo e o sentido do tráfego
+        InstalarFluxosCliente("ns3::TcpSocketFactory",
+                              wifiClients.Get(i),
+                              wifiInterfaces.GetAddress(i),
+                              serverNode.Get(0),
+                              p2pInterfaces.GetAddress(0),
+                              m_port,
+                              i,
+                              nClients/2,
+                              simulationTime);
     }
 
     // Habilitar o roteamento
     Ipv4GlobalRoutingHelper::PopulateRoutingTables();
 
     // Habilita o rastreamento de pacotes (opcional)
-    pointToPoint.EnablePcapAll("udp-tcp-mobility");
-    phy.EnablePcap("udp-tcp-mobility", apDevice.Get(0));
+    pointToPoint.EnablePcapAll(Saida("udp-tcp-no-mobility"));
+    phy.EnablePcap(Saida("udp-tcp-no-mobility"), apDevice.Get(0));
 
     // Configurar o FlowMonitor
     FlowMonitorHelper flowmonHelper;
-    Ptr<FlowMonitor> monitor = flowmonHelper.InstallAll();
+    Ptr<FlowMonitor> monitor = InstalarMonitor(flowmonHelper);
+    ConectarRegistroAtrasos();
+    ConectarDecomposicaoLatencia();
+    ConectarCausasDescarte();
+    ConectarTelemetria();
+    ConectarInternosTcp();
+    ConectarMapaCalor();
+    ConectarInicioClientes();
+    ConectarRotatividade();
+    ConectarTaxaPhy();
+    ConfigurarEdca();
+    ConectarColisoes();
 
     // Iniciar a simulação
     Simulator::Stop(Seconds(simulationTime));
@@ -1009,11 +4895,9 @@ tcp_udp_NoMobility()
 
 
     // Relatório do FlowMonitor
-    monitor->CheckForLostPackets();
-    Ptr<Ipv4FlowClassifier> classifier =
-        DynamicCast<Ipv4FlowClassifier>(flowmonHelper.GetClassifier());
-    std::map<FlowId, FlowMonitor::FlowStats> stats = monitor->GetFlowStats();
-    monitor->SerializeToXmlFile("UDP-TCP-No-Mobility.xml", true, true);
+    Ptr<Ipv4FlowClassifier> classifier;
+    std::map<FlowId, FlowMonitor::FlowStats> stats =
+        ColetarFluxos(flowmonHelper, monitor, Saida("UDP-TCP-No-Mobility.xml"), classifier);
     if (stats.empty())
     {
         NS_LOG_ERROR("Nenhum fluxo coletado.");
@@ -1039,13 +4923,30 @@ tcp_udp_NoMobility()
         std::cout << flow.first << "\t\t"         // Fluxo ID
                   << t.sourceAddress << "\t"      // Endereço de origem
                   << t.destinationAddress << "\t" // Endereço de destino
-                  << std::setw(5) << (flow.second.rxBytes * 8.0 / simulationTime) / 1e6
+                  << std::setw(5) << GoodputFluxo(t, flow.second, simulationTime)
                   << "\t"                                          // Taxa em Mbps, alinhada
                   << std::setw(5) << averageDelayMs << "\t"        // Atraso médio em ms, alinhado
                   << std::setw(5) << packetLossPercentage << "\n"; // Perda de pacotes, alinhada
     }
 
-    AnimationInterface anim("AnimUdpTcpNoMobility.xml");
+    ImprimirRelatorioTcp(stats, classifier, simulationTime);
+
+    CalcularResumo(stats, classifier, simulationTime);
+    GravarResultadosBanco(4, stats, classifier, simulationTime);
+    ImprimirRelatorioTrafego(stats, classifier, simulationTime);
+    ImprimirRelatorioClasses(stats, classifier, simulationTime);
+    ImprimirUtilizacaoEnlaces(stats, classifier, simulationTime);
+    ImprimirPercentisAtraso(stats, classifier);
+    ImprimirRelatorioQos(stats, classifier);
+    ImprimirDecomposicaoLatencia();
+    ImprimirCausasDescarte();
+    ImprimirTelemetria();
+    ImprimirMapaCalor();
+    ImprimirInicioClientes(simulationTime);
+    ImprimirRotatividade();
+    ImprimirColisoes();
+
+    AnimationInterface anim(Saida("AnimUdpTcpNoMobility.xml"));
 
     anim.SetConstantPosition(serverNode.Get(0), 0, 0);
     anim.SetConstantPosition(apNode.Get(0), 40, 40);
@@ -1089,11 +4990,14 @@ tcp_udp_Mobility()
     // Configurar o link cabeado (servidor <-> AP)
     NodeContainer p2pNodes = NodeContainer(serverNode.Get(0), apNode.Get(0));
     PointToPointHelper pointToPoint;
-    pointToPoint.SetDeviceAttribute("DataRate", StringValue("100Mbps"));
-    pointToPoint.SetChannelAttribute("Delay", StringValue("2ms"));
+    pointToPoint.SetDeviceAttribute("DataRate", StringValue(p2pDataRate));
+    pointToPoint.SetChannelAttribute("Delay", StringValue(p2pDelay));
 
     NetDeviceContainer p2pDevices = pointToPoint.Install(p2pNodes);
 
+    // Perdas, variação de atraso e utilização do enlace cabeado
+    ConfigurarEnlaceP2P(p2pDevices);
+
     // Configurar a rede Wi-Fi
     WifiHelper wifi;
     wifi.SetStandard(WIFI_STANDARD_80211g);
@@ -1156,6 +5060,9 @@ tcp_udp_Mobility()
     MobilityServer.SetPositionAllocator(positionServer);
     mobility.Install(serverNode);
 
+    // Topologia dos clientes ao redor do AP
+    PosicionarClientes(wifiClients, apNode.Get(0));
+
     // Instalar a pilha de Internet
     InternetStackHelper stack;
     stack.Install(serverNode);
@@ -1174,6 +5081,9 @@ tcp_udp_Mobility()
     Ipv4InterfaceContainer wifiInterfaces = address.Assign(clientDevices);
     address.Assign(apDevice);
 
+    // Disciplina de fila no AP e no enlace cabeado
+    InstalarFilas(apDevice, p2pDevices);
+
     // Configurar aplicações
     uint16_t tcpPort = 9;  // Porta TCP
     uint16_t udpPort = nClients + 10; // Porta UDP
@@ -1182,58 +5092,55 @@ tcp_udp_Mobility()
     {
         u_int16_t m_port = udpPort + i;
 
-        // Aplicação no servidor
-        PacketSinkHelper sinkHelper("ns3::UdpSocketFactory", InetSocketAddress(p2pInterfaces.GetAddress(0), m_port));
-        ApplicationContainer serverApp = sinkHelper.Install(serverNode.Get(0));
-        serverApp.Start(Seconds(1.0));
-        serverApp.Stop(Seconds(simulationTime));
-
-        // Aplicação nos clientes
-        OnOffHelper onoffHelper("ns3::UdpSocketFactory", InetSocketAddress(p2pInterfaces.GetAddress(0), m_port));
-        onoffHelper.SetAttribute("DataRate", StringValue("1Mbps"));  // Taxa de dados de 1 Mbps
-        onoffHelper.SetAttribute("PacketSize", UintegerValue(1024));  // Tamanho do pacote de 1024 bytes
-        onoffHelper.SetAttribute("OnTime", StringValue("ns3::ConstantRandomVariable[Constant=1.0]"));  // Tempo de atividade 1 segundo
-        onoffHelper.SetAttribute("OffTime", StringValue("ns3::ConstantRandomVariable[Constant=0.0]")); // Tempo de inatividade 0 segundos
-
-
-        ApplicationContainer clientApps = onoffHelper.Install(wifiClients.Get(i));
-        clientApps.Start(Seconds(2.0));
-        clientApps.Stop(Seconds(simulationTime));
+        // Gerador e receptor no cliente e no servidor, conforme o modelo e o sentido do tráfego
+        InstalarFluxosCliente("ns3::UdpSocketFactory",
+                              wifiClients.Get(i),
+                              wifiInterfaces.GetAddress(i),
+                              serverNode.Get(0),
+                              p2pInterfaces.GetAddress(0),
+                              m_port,
+                              i,
+                              nClients/2,
+                              simulationTime);
     }
 
     for (u_int32_t i = 0; i < nClients/2; i++)
     {
         u_int16_t m_port = tcpPort + i;
 
-        // Aplicação no servidor
-        PacketSinkHelper sinkHelper("ns3::TcpSocketFactory", InetSocketAddress(p2pInterfaces.GetAddress(0), m_port));
-        ApplicationContainer serverApp = sinkHelper.Install(serverNode.Get(0));
-        serverApp.Start(Seconds(1.0));
-        serverApp.Stop(Seconds(simulationTime));
-
-        // Aplicação nos clientes
-        OnOffHelper onoffHelper("ns3::TcpSocketFactory", InetSocketAddress(p2pInterfaces.GetAddress(0), m_port));
-        onoffHelper.SetAttribute("DataRate", StringValue("1Mbps"));  // Taxa de dados de 1 Mbps
-        onoffHelper.SetAttribute("PacketSize", UintegerValue(1024));  // Tamanho do pacote de 1024 bytes
-        onoffHelper.SetAttribute("OnTime", StringValue("ns3::ConstantRandomVariable[Constant=1.0]"));  // Tempo de atividade 1 segundo
-        onoffHelper.SetAttribute("OffTime", StringValue("ns3::ConstantRandomVariable[Constant=0.0]")); // Tempo de inatividade 0 segundos
-
-
-        ApplicationContainer clientApps = onoffHelper.Install(wifiClients.Get(i));
-        clientApps.Start(Seconds(2.0));
-        clientApps.Stop(Seconds(simulationTime));
+        // Gerador e receptor no cliente e no servidor, conforme o modelo e o sentido do tráfego
+        InstalarFluxosCliente("ns3::TcpSocketFactory",
+                              wifiClients.Get(i),
+                              wifiInterfaces.GetAddress(i),
+                              serverNode.Get(0),
+                              p2pInterfaces.GetAddress(0),
+                              m_port,
+                              i,
+                              nClients/2,
+                              simulationTime);
     }
 
     // Habilitar o roteamento
     Ipv4GlobalRoutingHelper::PopulateRoutingTables();
 
     // Habilita o rastreamento de pacotes 
-    pointToPoint.EnablePcapAll("udp-tcp-mobility");
-    phy.EnablePcap("udp-tcp-mobility", apDevice.Get(0));
+    pointToPoint.EnablePcapAll(Saida("udp-tcp-mobility"));
+    phy.EnablePcap(Saida("udp-tcp-mobility"), apDevice.Get(0));
 
     // Configurar o FlowMonitor
     FlowMonitorHelper flowmonHelper;
-    Ptr<FlowMonitor> monitor = flowmonHelper.InstallAll();
+    Ptr<FlowMonitor> monitor = InstalarMonitor(flowmonHelper);
+    ConectarRegistroAtrasos();
+    ConectarDecomposicaoLatencia();
+    ConectarCausasDescarte();
+    ConectarTelemetria();
+    ConectarInternosTcp();
+    ConectarMapaCalor();
+    ConectarInicioClientes();
+    ConectarRotatividade();
+    ConectarTaxaPhy();
+    ConfigurarEdca();
+    ConectarColisoes();
 
     // Iniciar a simulação
     Simulator::Stop(Seconds(simulationTime));
@@ -1241,11 +5148,9 @@ tcp_udp_Mobility()
     NS_LOG_INFO("Simulação finalizada.");
 
     // Relatório do FlowMonitor
-    monitor->CheckForLostPackets();
-    Ptr<Ipv4FlowClassifier> classifier =
-        DynamicCast<Ipv4FlowClassifier>(flowmonHelper.GetClassifier());
-    std::map<FlowId, FlowMonitor::FlowStats> stats = monitor->GetFlowStats();
-    monitor->SerializeToXmlFile("UDP-TCP-Mobility.xml", true, true);
+    Ptr<Ipv4FlowClassifier> classifier;
+    std::map<FlowId, FlowMonitor::FlowStats> stats =
+        ColetarFluxos(flowmonHelper, monitor, Saida("UDP-TCP-Mobility.xml"), classifier);
     if (stats.empty())
     {
         NS_LOG_ERROR("Nenhum fluxo coletado.");
@@ -1271,13 +5176,30 @@ tcp_udp_Mobility()
         std::cout << flow.first << "\t\t"         // Fluxo ID
                   << t.sourceAddress << "\t"      // Endereço de origem
                   << t.destinationAddress << "\t" // Endereço de destino
-                  << std::setw(5) << (flow.second.rxBytes * 8.0 / simulationTime) / 1e6
+                  << std::setw(5) << GoodputFluxo(t, flow.second, simulationTime)
                   << "\t"                                          // Taxa em Mbps, alinhada
                   << std::setw(5) << averageDelayMs << "\t"        // Atraso médio em ms, alinhado
                   << std::setw(5) << packetLossPercentage << "\n"; // Perda de pacotes, alinhada
     }
 
-    AnimationInterface anim("AnimUdpTcpMobility.xml");
+    ImprimirRelatorioTcp(stats, classifier, simulationTime);
+
+    CalcularResumo(stats, classifier, simulationTime);
+    GravarResultadosBanco(5, stats, classifier, simulationTime);
+    ImprimirRelatorioTrafego(stats, classifier, simulationTime);
+    ImprimirRelatorioClasses(stats, classifier, simulationTime);
+    ImprimirUtilizacaoEnlaces(stats, classifier, simulationTime);
+    ImprimirPercentisAtraso(stats, classifier);
+    ImprimirRelatorioQos(stats, classifier);
+    ImprimirDecomposicaoLatencia();
+    ImprimirCausasDescarte();
+    ImprimirTelemetria();
+    ImprimirMapaCalor();
+    ImprimirInicioClientes(simulationTime);
+    ImprimirRotatividade();
+    ImprimirColisoes();
+
+    AnimationInterface anim(Saida("AnimUdpTcpMobility.xml"));
 
     anim.SetConstantPosition(serverNode.Get(0), 0, 0);
     anim.SetConstantPosition(apNode.Get(0), 40, 40);
@@ -1300,14 +5222,310 @@ tcp_udp_Mobility()
     Simulator::Destroy();
 }
 
-int
-main(int argc, char* argv[])
+// Limpa o estado global deixado por uma execução anterior
+void
+ReiniciarEstado()
 {
-    std::int16_t scenario = 1;
-    RngSeedManager::SetSeed (time (0));
-    RngSeedManager::SetRun (rand()); 
+    tcpStats.clear();
+    tcpHighestSeq.clear();
+    tcpTracedSockets.clear();
+    registeredFlows.clear();
+    sampledClassifier = nullptr;
+    sampledFlows.clear();
+    sampledInFlight.clear();
+    sampledPeakInFlight = 0;
+    latencyInFlight.clear();
+    latencyFlows.clear();
+    dropCauseNames.clear();
+    dropCauseIds.clear();
+    dropsPerNode.clear();
+    dropsPerFlow.clear();
+    telemetryQueues.clear();
+    telemetryEnqueued.clear();
+    telemetrySamples.clear();
+    telemetryCurrent = AmostraTelemetria();
+    telemetryStateTime.clear();
+    heatmapStations.clear();
+    heatmapCurrent.clear();
+    heatmapGrid.clear();
+    clientStartOffsets.clear();
+    associationTimes.clear();
+    sinkRxBins.clear();
+    churnSessions.clear();
+    churnScheduled = false;
+    churnSlots = 0;
+    churnBlocked = 0;
+    churnNodeSlot.clear();
+    churnAssociatedNodes.clear();
+    churnAddresses.clear();
+    churnInFlight.clear();
+    churnCurrent = JanelaRotatividade();
+    churnBins.clear();
+    tcpInternals.clear();
+    tcpInternalsIndex.clear();
+    tcpInternalsLastSample = 0;
+    lastRun = ResumoExecucao();
+    phyDataBits = 0;
+    phyDataTime = 0;
+    collisions = ContadoresColisao();
+    Ipv4AddressGenerator::Reset();
+    // Os fluxos aleatórios automáticos são numerados em ordem de criação no processo; sem
+    // reiniciar a contagem, a segunda execução com a mesma chave de cache usaria outros fluxos
+    RngSeedManager::ResetNextStreamIndex();
+}
+
+// Descrição completa da configuração de uma execução: versão do ns-3 e do binário, cenário,
+// sementes, parâmetros do script e os valores padrão de todos os atributos e valores globais
+std::string
+DescreverConfiguracao(std::int16_t scenario)
+{
+    std::ostringstream description;
+#ifdef ENABLE_BUILD_VERSION
+    description << "ns3=" << Version::LongVersion() << "\n";
+#endif
+    description << "scenario=" << scenario << "\nseed=" << RngSeedManager::GetSeed()
+                << "\nrun=" << RngSeedManager::GetRun() << "\nsimulationTime=" << SIMULATION_TIME
+                << "\nnClients=" << nClients << "\ntcpVariant=" << tcpVariant
+                << "\ntcpInitialCwnd=" << tcpInitialCwnd << "\ntcpSegmentSize=" << tcpSegmentSize
+                << "\ntcpSndBufSize=" << tcpSndBufSize << "\ntcpRcvBufSize=" << tcpRcvBufSize
+                << "\nqueueDisc=" << queueDisc << "\nwifiMacQueueSize=" << wifiMacQueueSize
+                << "\np2pDataRate=" << p2pDataRate << "\np2pDelay=" << p2pDelay
+                << "\np2pJitter=" << p2pJitter << "\np2pErrorModel=" << p2pErrorModel
+                << "\np2pErrorRate=" << p2pErrorRate << "\np2pBurstSize=" << p2pBurstSize
+                << "\ntrafficMix=" << trafficMix << "\ntrafficDataRate=" << trafficDataRate
+                << "\ntrafficPacketSize=" << trafficPacketSize
+                << "\ntrafficDirection=" << trafficDirection
+                << "\nstartDistribution=" << startDistribution << "\nstartSpread=" << startSpread
+                << "\nchurnArrivalRate=" << churnArrivalRate
+                << "\nchurnSessionMean=" << churnSessionMean << "\nchurnPool=" << churnPool
+                << "\nqos=" << qos << "\nqosMarking=" << qosMarking << "\nqosEdca=" << qosEdca
+                << "\nclientTopology=" << clientTopology << "\ntopologyRadius=" << topologyRadius
+                << "\nrtsThreshold=" << rtsThreshold
+                << "\nfragmentationThreshold=" << fragmentationThreshold
+                << "\ncollisionStats=" << (collisionStats || rtsCompare)
+                << "\nflowSampling=" << flowSampling << "\nloadSweep=" << loadSweep << "\n";
+
+    for (auto it = GlobalValue::Begin(); it != GlobalValue::End(); it++)
+    {
+        StringValue value;
+        (*it)->GetValue(value);
+        description << (*it)->GetName() << "=" << value.Get() << "\n";
+    }
+
+    for (uint32_t i = 0; i < TypeId::GetRegisteredN(); i++)
+    {
+        TypeId tid = TypeId::GetRegistered(i);
+        for (std::size_t j = 0; j < tid.GetAttributeN(); j++)
+        {
+            TypeId::AttributeInformation info = tid.GetAttribute(j);
+            description << tid.GetName() << "::" << info.name << "="
+                        << info.initialValue->SerializeToString(info.checker) << "\n";
+        }
+    }
+    return description.str();
+}
+
+// Hash FNV-1a de 64 bits, usado como endereço da entrada no cache
+std::string
+HashConfiguracao(const std::string& description)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : description)
+    {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    std::ostringstream hex;
+    hex << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return hex.str();
+}
+
+// Procura o resumo da configuração no cache. A descrição gravada junto do resumo é comparada
+// por inteiro, então uma colisão de hash é tratada como falta.
+bool
+LerCache(const std::string& key, const std::string& description)
+{
+    std::ifstream file(cacheDir + "/" + key + ".txt");
+    if (!file)
+    {
+        return false;
+    }
+
+    ResumoExecucao summary;
+    file >> summary.offeredMbps >> summary.goodputMbps >> summary.lossPercent >>
+        summary.p99DelayMs >> summary.minGoodputRatio >> summary.flows >> summary.meanDelayMs >>
+        summary.phyRateMbps >> summary.collisionPercent;
+    if (!file)
+    {
+        return false;
+    }
+    file.ignore();
+    std::string stored((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (stored != description)
+    {
+        return false;
+    }
+    lastRun = summary;
+    return true;
+}
+
+void
+GravarCache(const std::string& key, const std::string& description)
+{
+    // Grava em um arquivo temporário e renomeia, para que uma execução concorrente nunca leia
+    // uma entrada pela metade
+    std::string path = cacheDir + "/" + key + ".txt";
+    std::ofstream file(path + ".tmp");
+    file << std::setprecision(17) << lastRun.offeredMbps << " " << lastRun.goodputMbps << " "
+         << lastRun.lossPercent << " " << lastRun.p99DelayMs << " " << lastRun.minGoodputRatio
+         << " " << lastRun.flows << " " << lastRun.meanDelayMs << " " << lastRun.phyRateMbps << " "
+         << lastRun.collisionPercent << "\n"
+         << description;
+    file.close();
+    std::rename((path + ".tmp").c_str(), path.c_str());
+}
+
+// Mantém o índice (cenário, clientes, sementes) -> chaves, só para consulta: as entradas são
+// endereçadas pelo conteúdo da configuração e nunca ficam obsoletas, então várias configurações
+// com o mesmo rótulo (varreduras de parâmetros) convivem. O índice é reescrito sob flock e
+// trocado por rename, para não se perder entre execuções concorrentes.
+void
+AtualizarIndiceCache(std::int16_t scenario, const std::string& key)
+{
+    std::ostringstream label;
+    label << scenario << "/" << nClients << "/" << RngSeedManager::GetSeed() << "/"
+          << RngSeedManager::GetRun();
+
+    int lock = open((cacheDir + "/indice.lock").c_str(), O_CREAT | O_RDWR, 0644);
+    if (lock < 0 || flock(lock, LOCK_EX) != 0)
+    {
+        NS_FATAL_ERROR("Não foi possível travar o índice do cache em " << cacheDir);
+    }
+
+    std::set<std::pair<std::string, std::string>> index;
+    std::ifstream input(cacheDir + "/indice.txt");
+    std::string entry;
+    std::string entryKey;
+    while (input >> entry >> entryKey)
+    {
+        index.emplace(entry, entryKey);
+    }
+    input.close();
+
+    if (index.emplace(label.str(), key).second)
+    {
+        std::ofstream output(cacheDir + "/indice.txt.tmp");
+        for (const auto& item : index)
+        {
+            output << item.first << " " << item.second << "\n";
+        }
+        output.close();
+        std::rename((cacheDir + "/indice.txt.tmp").c_str(), (cacheDir + "/indice.txt").c_str());
+    }
+
+    flock(lock, LOCK_UN);
+    close(lock);
+}
+
+// Cria o diretório exclusivo da execução em outputDir, nomeado pelo cenário, clientes, sementes
+// e hash da configuração. O mkdir é atômico, então execuções concorrentes com a mesma
+// configuração recebem sufixos diferentes em vez de sobrescreverem as saídas uma da outra.
+void
+CriarDiretorioExecucao(std::int16_t scenario, const std::string& key)
+{
+    const char* names[] = {"tcp-no-mobility",
+                           "udp-no-mobility",
+                           "tcp-mobility",
+                           "udp-mobility",
+                           "udp-tcp-no-mobility",
+                           "udp-tcp-mobility"};
+
+    std::ostringstream base;
+    base << outputDir << "/" << names[scenario] << "-n" << nClients << "-s"
+         << RngSeedManager::GetSeed() << "-r" << RngSeedManager::GetRun() << "-" << key.substr(0, 8);
+
+    SystemPath::MakeDirectories(outputDir);
+    for (uint32_t attempt = 1;; attempt++)
+    {
+        std::string candidate = base.str() + (attempt > 1 ? "-" + std::to_string(attempt) : "");
+        if (mkdir(candidate.c_str(), 0755) == 0)
+        {
+            runDir = candidate;
+            return;
+        }
+        if (errno != EEXIST)
+        {
+            NS_FATAL_ERROR("Não foi possível criar o diretório " << candidate);
+        }
+    }
+}
+
+// Grava a configuração e o manifesto com os arquivos produzidos pela execução
+void
+GravarManifesto(std::int16_t scenario, const std::string& key, const std::string& description)
+{
+    std::ofstream(Saida("configuracao.txt")) << description;
+
+    std::ofstream manifest(Saida("manifest.txt"));
+    manifest << "scenario=" << scenario << "\nnClients=" << nClients
+             << "\nseed=" << RngSeedManager::GetSeed() << "\nrun=" << RngSeedManager::GetRun()
+             << "\nkey=" << key << "\n";
+    for (const std::string& name : SystemPath::ReadFiles(runDir))
+    {
+        if (name == "manifest.txt")
+        {
+            continue;
+        }
+        std::ifstream file(Saida(name), std::ios::binary | std::ios::ate);
+        manifest << name << "\t" << file.tellg() << "\n";
+    }
+}
+
+// Saídas opcionais que só existem se a execução for simulada: o cache guarda apenas o resumo
+bool
+SaidasPorExecucao()
+{
+    return !resultsDb.empty() || delayLog || latencySampling > 0 || dropCauses ||
+           telemetryInterval > 0 || tcpTraceInterval > 0 || heatmapInterval > 0;
+}
+
+// Executa o cenário selecionado, consultando antes o cache de resultados quando habilitado. Com
+// saídas por execução pedidas (banco de resultados, registros e relatórios opcionais) o cache não
+// é consultado, para que nenhuma execução fique de fora, mas continua sendo gravado.
+void
+ExecutarCenario(std::int16_t scenario)
+{
+    std::string description = DescreverConfiguracao(scenario);
+    std::string key = HashConfiguracao(description);
+    runKey = key;
+    if (resultCache)
+    {
+        SystemPath::MakeDirectories(cacheDir);
+        AtualizarIndiceCache(scenario, key);
+
+        if (SaidasPorExecucao())
+        {
+            NS_LOG_UNCOND("Cache: consulta ignorada, a execução tem saídas próprias");
+        }
+        else if (LerCache(key, description))
+        {
+            cacheHits++;
+            NS_LOG_UNCOND("Cache: acerto " << key << " (goodput " << lastRun.goodputMbps
+                                           << " Mbps, perda " << lastRun.lossPercent
+                                           << "%, p99 " << lastRun.p99DelayMs << " ms)");
+            return;
+        }
+        else
+        {
+            cacheMisses++;
+            NS_LOG_UNCOND("Cache: falta " << key << ", simulando");
+        }
+    }
+
+    ReiniciarEstado();
+    CriarDiretorioExecucao(scenario, key);
+    NS_LOG_UNCOND("Saídas da execução em " << runDir);
 
-    // Executar o cenário selecionado
     if (scenario == 0)
     {
         tcpNoMobility();
@@ -1332,6 +5550,680 @@ main(int argc, char* argv[])
     {
         tcp_udp_Mobility();
     }
-    
+
+    FecharRegistroAtrasos();
+    FecharInternosTcp();
+    GravarManifesto(scenario, key, description);
+    if (resultCache)
+    {
+        GravarCache(key, description);
+    }
+}
+
+bool
+AtendeSla(const ResumoExecucao& summary)
+{
+    return summary.lossPercent <= slaMaxLoss && summary.p99DelayMs <= slaMaxP99Delay &&
+           summary.minGoodputRatio >= slaMinGoodput;
+}
+
+// Joelho da curva goodput x carga (método Kneedle): ponto de maior distância acima da reta
+// que liga os extremos da curva normalizada
+uint32_t
+DetectarJoelho(const std::map<uint32_t, ResumoExecucao>& curve)
+{
+    if (curve.size() < 3)
+    {
+        return 0;
+    }
+
+    double minX = curve.begin()->second.offeredMbps;
+    double maxX = curve.rbegin()->second.offeredMbps;
+    double minY = curve.begin()->second.goodputMbps;
+    double maxY = minY;
+    for (const auto& point : curve)
+    {
+        minY = std::min(minY, point.second.goodputMbps);
+        maxY = std::max(maxY, point.second.goodputMbps);
+    }
+    if (maxX <= minX || maxY <= minY)
+    {
+        return 0;
+    }
+
+    uint32_t knee = 0;
+    double bestDistance = 0;
+    for (const auto& point : curve)
+    {
+        double x = (point.second.offeredMbps - minX) / (maxX - minX);
+        double y = (point.second.goodputMbps - minY) / (maxY - minY);
+        if (y - x > bestDistance)
+        {
+            bestDistance = y - x;
+            knee = point.first;
+        }
+    }
+    return knee;
+}
+
+// Procura o maior número de clientes que atende ao SLA: dobra nClients até a primeira violação
+// e depois faz uma bisseção entre o último valor aprovado e o primeiro reprovado
+void
+BuscarCapacidade(std::int16_t scenario)
+{
+    // Os cenários mistos dividem os clientes entre TCP e UDP, então andam de 2 em 2
+    uint32_t step = scenario >= 4 ? 2 : 1;
+    std::map<uint32_t, ResumoExecucao> curve;
+
+    auto executar = [&](uint32_t clients) {
+        nClients = clients;
+        ExecutarCenario(scenario);
+        curve[clients] = lastRun;
+        NS_LOG_UNCOND("Busca de capacidade: " << clients << " clientes -> "
+                                              << (AtendeSla(lastRun) ? "atende" : "viola")
+                                              << " o SLA");
+        return AtendeSla(lastRun);
+    };
+
+    uint32_t pass = 0;
+    uint32_t fail = 0;
+    for (uint32_t clients = step; clients <= searchMaxClients; clients *= 2)
+    {
+        if (!executar(clients))
+        {
+            fail = clients;
+            break;
+        }
+        pass = clients;
+    }
+
+    while (fail > 0 && fail - pass > step)
+    {
+        uint32_t middle = pass + (fail - pass) / (2 * step) * step;
+        if (executar(middle))
+        {
+            pass = middle;
+        }
+        else
+        {
+            fail = middle;
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(6);
+    std::cout << "\t\t\t|================= Busca de capacidade =================|\n";
+    std::cout << "SLA: perda <= " << slaMaxLoss << "%, p99 <= " << slaMaxP99Delay
+              << " ms, goodput por fluxo >= " << slaMinGoodput << "% da carga\n";
+    std::cout << "Clientes\tCarga (Mbps)\tGoodput (Mbps)\tPerda (%)\tp99 (ms)\tMenor goodput "
+                 "(%)\tSLA\n";
+    for (const auto& point : curve)
+    {
+        std::cout << point.first << "\t\t" << std::setw(5) << point.second.offeredMbps << "\t"
+                  << std::setw(5) << point.second.goodputMbps << "\t" << std::setw(5)
+                  << point.second.lossPercent << "\t" << std::setw(5) << point.second.p99DelayMs
+                  << "\t" << std::setw(5) << point.second.minGoodputRatio << "\t\t"
+                  << (AtendeSla(point.second) ? "ok" : "violado") << "\n";
+    }
+
+    uint32_t knee = DetectarJoelho(curve);
+    if (knee > 0)
+    {
+        std::cout << "Joelho da curva goodput x carga: " << knee << " clientes\n";
+    }
+    if (fail == 0)
+    {
+        std::cout << "Capacidade máxima: >= " << pass << " clientes (limite da busca atingido)\n";
+    }
+    else
+    {
+        std::cout << "Capacidade máxima: " << pass << " clientes\n";
+    }
+}
+
+// Varre tamanho de pacote x carga oferecida por cliente dos geradores Cbr/Poisson, com uma
+// execução completa por ponto. Os demais modelos (Bulk, Http, Voip) não usam trafficDataRate: se
+// nenhum cliente segue a carga, o eixo de carga é omitido (carga 0 no CSV). Goodput e carga são
+// contados em bytes de aplicação (CalcularResumo), para que os cabeçalhos não inflem os pontos de
+// pacotes pequenos. A eficiência MAC é o goodput agregado sobre a taxa PHY média dos quadros de
+// dados, com todo o overhead de IP, transporte e MAC; a saturação de cada tamanho é a primeira
+// carga em que o goodput fica abaixo de 90% da carga oferecida.
+void
+VarrerCarga(std::int16_t scenario)
+{
+    std::vector<double> sizes = ListaNumeros("sweepPacketSizes", sweepPacketSizes);
+    std::vector<double> loads = ListaNumeros("sweepLoads", sweepLoads);
+    std::string dataRate = trafficDataRate;
+    uint32_t packetSize = trafficPacketSize;
+
+    uint32_t fixedClients = 0;
+    for (uint32_t i = 0; i < nClients; i++)
+    {
+        std::string model = ModeloDeTrafego(i, nClients);
+        fixedClients += model != "Cbr" && model != "Poisson";
+    }
+    bool loadAxis = fixedClients < nClients;
+    if (!loadAxis)
+    {
+        loads = {0};
+    }
+
+    // Cada ponto guarda a própria carga, pois tamanhos repetidos acumulam no mesmo grupo
+    std::map<uint32_t, std::vector<std::pair<double, ResumoExecucao>>> points;
+    for (double size : sizes)
+    {
+        for (double load : loads)
+        {
+            trafficPacketSize = size;
+            if (loadAxis)
+            {
+                trafficDataRate = std::to_string(uint64_t(load * 1e6)) + "bps";
+            }
+            ExecutarCenario(scenario);
+            points[trafficPacketSize].push_back({load, lastRun});
+            NS_LOG_UNCOND("Varredura: " << trafficPacketSize << " bytes, " << load
+                                        << " Mbps/cliente -> " << lastRun.goodputMbps
+                                        << " Mbps");
+        }
+    }
+    trafficDataRate = dataRate;
+    trafficPacketSize = packetSize;
+
+    SystemPath::MakeDirectories(outputDir);
+    std::ofstream csv(outputDir + "/varredura-cenario" + std::to_string(scenario) + ".csv");
+    csv << "packetSize,loadPerClientMbps,offeredMbps,goodputMbps,phyRateMbps,macEfficiency,"
+           "meanDelayMs,p99DelayMs,lossPercent\n";
+
+    std::cout << std::fixed << std::setprecision(6);
+    std::cout << "\t\t\t|================= Varredura tamanho x carga =================|\n";
+    if (!loadAxis)
+    {
+        std::cout << "Nenhum cliente usa Cbr/Poisson: a carga não se aplica e só o tamanho varia\n";
+    }
+    else if (fixedClients > 0)
+    {
+        std::cout << fixedClients << " de " << nClients
+                  << " clientes (Bulk/Http/Voip) ignoram a carga da varredura\n";
+    }
+    std::cout << "Pacote (B)\tCarga/cliente (Mbps)\tGoodput de aplicação (Mbps)\t"
+                 "Eficiência MAC (%)\tAtraso médio (ms)\tp99 (ms)\tPerda (%)\n";
+    std::map<uint32_t, std::pair<double, double>> saturation; // Tamanho -> (carga, goodput máx.)
+    for (const auto& size : points)
+    {
+        double maxGoodput = 0;
+        double saturationLoad = -1;
+        for (const auto& run : size.second)
+        {
+            double load = run.first;
+            const ResumoExecucao& point = run.second;
+            double efficiency =
+                point.phyRateMbps > 0 ? 100 * point.goodputMbps / point.phyRateMbps : 0;
+            csv << size.first << "," << load << "," << point.offeredMbps << ","
+                << point.goodputMbps << "," << point.phyRateMbps << "," << efficiency / 100 << ","
+                << point.meanDelayMs << "," << point.p99DelayMs << "," << point.lossPercent
+                << "\n";
+            std::cout << size.first << "\t\t" << std::setw(5) << load << "\t\t\t"
+                      << std::setw(5) << point.goodputMbps << "\t" << std::setw(5) << efficiency
+                      << "\t\t" << std::setw(5) << point.meanDelayMs << "\t\t" << std::setw(5)
+                      << point.p99DelayMs << "\t" << std::setw(5) << point.lossPercent << "\n";
+
+            maxGoodput = std::max(maxGoodput, point.goodputMbps);
+            if (saturationLoad < 0 && point.offeredMbps > 0 &&
+                point.goodputMbps < 0.9 * point.offeredMbps)
+            {
+                saturationLoad = load;
+            }
+        }
+        saturation[size.first] = {saturationLoad, maxGoodput};
+    }
+
+    std::cout << "Pacote (B)\tSaturação (Mbps/cliente)\tGoodput máximo (Mbps)\n";
+    for (const auto& size : saturation)
+    {
+        std::cout << size.first << "\t\t";
+        if (!loadAxis)
+        {
+            std::cout << "n/a";
+        }
+        else if (size.second.first < 0)
+        {
+            std::cout << "> " << *std::max_element(loads.begin(), loads.end());
+        }
+        else
+        {
+            std::cout << size.second.first;
+        }
+        std::cout << "\t\t\t" << size.second.second << "\n";
+    }
+}
+
+// Limiares de RTS/CTS e de fragmentação, lidos pelas estações na criação dos dispositivos
+void
+AplicarLimiaresWifi()
+{
+    Config::SetDefault("ns3::WifiRemoteStationManager::RtsCtsThreshold",
+                       UintegerValue(rtsThreshold));
+    Config::SetDefault("ns3::WifiRemoteStationManager::FragmentationThreshold",
+                       UintegerValue(fragmentationThreshold));
+}
+
+// Executa o cenário sem proteção e com RTS/CTS em todos os quadros de dados e compara colisões,
+// vazão e atraso
+void
+CompararRtsCts(std::int16_t scenario)
+{
+    uint32_t threshold = rtsThreshold;
+    std::map<uint32_t, ResumoExecucao> runs;
+    for (uint32_t protection : {65535u, 0u})
+    {
+        rtsThreshold = protection;
+        AplicarLimiaresWifi();
+        ExecutarCenario(scenario);
+        runs[protection] = lastRun;
+    }
+    rtsThreshold = threshold;
+    AplicarLimiaresWifi();
+
+    const ResumoExecucao& off = runs[65535];
+    const ResumoExecucao& on = runs[0];
+    std::cout << std::fixed << std::setprecision(6);
+    std::cout << "\t\t\t|========= RTS/CTS: sem x com proteção (" << clientTopology
+              << ") =========|\n";
+    std::cout << "Proteção\tColisões (%)\tGoodput (Mbps)\tAtraso médio (ms)\tp99 (ms)\t"
+                 "Perda (%)\n";
+    for (const auto& run : {std::make_pair("sem", off), std::make_pair("RTS/CTS", on)})
+    {
+        std::cout << run.first << "\t\t" << std::setw(5) << run.second.collisionPercent << "\t"
+                  << std::setw(5) << run.second.goodputMbps << "\t" << std::setw(5)
+                  << run.second.meanDelayMs << "\t\t" << std::setw(5) << run.second.p99DelayMs
+                  << "\t" << std::setw(5) << run.second.lossPercent << "\n";
+    }
+    if (off.goodputMbps > 0)
+    {
+        std::cout << "Ganho de goodput com RTS/CTS: "
+                  << 100 * (on.goodputMbps - off.goodputMbps) / off.goodputMbps << "%\n";
+    }
+}
+
+// Resultado do modelo de Bianchi para a DCF do 802.11 em saturação
+struct EstimativaDcf
+{
+    double tau = 0;             // Probabilidade de uma estação transmitir em um slot
+    double p = 0;               // Probabilidade condicional de colisão
+    double throughputMbps = 0;  // Goodput agregado de saturação
+    double perFlowMbps = 0;     // Goodput médio por fluxo (limitado pela carga oferecida)
+    double serviceTimeMs = 0;   // Tempo médio de serviço MAC por pacote
+    bool saturated = true;      // Alguma estação tem sempre um pacote na fila
+    double delayMs = 0;         // Atraso fim a fim estimado (MAC + enlace P2P), -1 = n/a
+};
+
+// Duração de um quadro ERP-OFDM (802.11g): preâmbulo e SIGNAL, símbolos de 4 µs com os bits
+// SERVICE/tail e a extensão de sinal de 6 µs
+double
+DuracaoOfdm(uint32_t bytes, double rateMbps)
+{
+    double bitsPerSymbol = rateMbps * 4;
+    double symbols = std::ceil((16 + 8.0 * bytes + 6) / bitsPerSymbol);
+    return 20e-6 + symbols * 4e-6 + 6e-6;
+}
+
+// Modelo de Bianchi (cadeia de Markov da DCF, acesso básico) para "stations" estações saturadas
+// transmitindo "payload" bytes de aplicação com "headers" bytes de IP/transporte
+EstimativaDcf
+EstimarDcf(uint32_t stations, uint32_t payload, uint32_t headers)
+{
+    const double slot = 9e-6;      // Slot curto do 802.11g
+    const double sifs = 10e-6;
+    const double difs = sifs + 2 * slot;
+    const double w = 16;           // CWmin + 1
+    const double m = 6;            // Estágios de backoff até CWmax = 1023
+    const uint32_t macOverhead = 8 + 24 + 4; // LLC/SNAP, cabeçalho MAC e FCS
+    const uint32_t ackBytes = 14;
+
+    EstimativaDcf estimate;
+
+    // Ponto fixo tau = f(p), p = 1 - (1 - tau)^(n-1) resolvido por bisseção
+    double low = 0;
+    double high = 1;
+    for (int i = 0; i < 100; i++)
+    {
+        double tau = (low + high) / 2;
+        double p = 1 - std::pow(1 - tau, stations - 1.0);
+        double f = 2 * (1 - 2 * p) / ((1 - 2 * p) * (w + 1) + p * w * (1 - std::pow(2 * p, m)));
+        if (f > tau)
+        {
+            low = tau;
+        }
+        else
+        {
+            high = tau;
+        }
+    }
+    estimate.tau = (low + high) / 2;
+    estimate.p = 1 - std::pow(1 - estimate.tau, stations - 1.0);
+
+    double ptr = 1 - std::pow(1 - estimate.tau, stations);
+    double ps = stations * estimate.tau * std::pow(1 - estimate.tau, stations - 1.0) / ptr;
+
+    // Sucesso: DATA + SIFS + ACK + DIFS; na colisão o ACK timeout tem praticamente a mesma duração
+    double data = DuracaoOfdm(payload + headers + macOverhead, dcfDataRate);
+    double ts = data + sifs + DuracaoOfdm(ackBytes, dcfControlRate) + difs;
+    double tc = ts;
+
+    double meanSlot = (1 - ptr) * slot + ptr * ps * ts + ptr * (1 - ps) * tc;
+    double throughput = ps * ptr * payload * 8 / meanSlot;
+
+    estimate.throughputMbps = throughput / 1e6;
+    estimate.perFlowMbps = throughput / stations / 1e6;
+    estimate.serviceTimeMs = payload * 8 / (throughput / stations) * 1000;
+    estimate.delayMs = estimate.serviceTimeMs +
+                       (payload + headers + 2 + 4) * 8.0 / DataRate(p2pDataRate).GetBitRate() * 1000 +
+                       Time(p2pDelay).GetSeconds() * 1000;
+    return estimate;
+}
+
+// Estimativa analítica para o cenário configurado, sem criar nenhum nó do ns-3
+EstimativaDcf
+ImprimirEstimativaDcf(std::int16_t scenario)
+{
+    // Estações disputando o meio: clientes ativos na subida e o AP na descida. Nos cenários
+    // mistos apenas nClients/2 clientes transmitem.
+    uint32_t clients = scenario >= 4 ? nClients / 2 : nClients;
+    uint32_t stations = (trafficDirection == "Uplink" ? clients : 0) +
+                        (trafficDirection == "Uplink" ? 0 : 1) +
+                        (trafficDirection == "Bidirectional" ? clients : 0);
+    stations = std::max<uint32_t>(stations, 1);
+
+    // TCP usa segmentos de tcpSegmentSize com a opção de timestamp (mesmos cabeçalhos de
+    // BytesAplicacao); os ACKs de volta não entram no modelo
+    bool tcp = scenario == 0 || scenario == 2;
+    uint32_t payload = tcp ? std::min(trafficPacketSize, tcpSegmentSize) : trafficPacketSize;
+    uint32_t headers = 20 + (tcp ? 20 + 12 : 8);
+
+    EstimativaDcf estimate = EstimarDcf(stations, payload, headers);
+
+    // Cada estação recebe 1/stations da vazão de saturação. Os clientes na subida têm um fluxo
+    // cada; a parcela do AP é dividida de forma max-min entre os seus fluxos de descida (dois por
+    // cliente nos cenários mistos). A carga de cada fluxo vem do seu modelo de tráfego; os modelos
+    // elásticos (Bulk, Http) ocupam toda a parcela disponível.
+    double share = estimate.throughputMbps / stations;
+    std::vector<double> demands;
+    for (uint32_t i = 0; i < clients; i++)
+    {
+        double offered = TaxaOferecida(ModeloDeTrafego(i, clients)) / 1e6;
+        demands.push_back(offered > 0 ? offered : std::numeric_limits<double>::infinity());
+    }
+
+    std::vector<double> goodputs;
+    bool saturated = false;
+    if (trafficDirection != "Downlink")
+    {
+        for (double demand : demands)
+        {
+            goodputs.push_back(std::min(demand, share));
+            saturated = saturated || demand >= share;
+        }
+    }
+    if (trafficDirection != "Uplink")
+    {
+        std::vector<double> apDemands;
+        for (uint32_t copy = 0; copy < (scenario >= 4 ? 2u : 1u); copy++)
+        {
+            apDemands.insert(apDemands.end(), demands.begin(), demands.end());
+        }
+        double apDemand = std::accumulate(apDemands.begin(), apDemands.end(), 0.0);
+        std::vector<double> fair = AlocacaoMaxMin(apDemands, share);
+        goodputs.insert(goodputs.end(), fair.begin(), fair.end());
+        saturated = saturated || apDemand >= share;
+    }
+    if (!goodputs.empty())
+    {
+        estimate.perFlowMbps =
+            std::accumulate(goodputs.begin(), goodputs.end(), 0.0) / goodputs.size();
+    }
+
+    // Fora da saturação a fila MAC esvazia entre pacotes e o tempo de serviço de Bianchi não vale
+    estimate.saturated = saturated;
+    if (!saturated)
+    {
+        estimate.delayMs = -1;
+    }
+
+    std::cout << std::fixed << std::setprecision(6);
+    std::cout << "\t\t\t|================= Estimativa analítica (Bianchi) =================|\n";
+    std::cout << "Estações\tPayload (B)\ttau\t\tp colisão\tSaturação (Mbps)\tPor fluxo "
+                 "(Mbps)\tServiço MAC (ms)\tAtraso (ms)\n";
+    std::cout << stations << "\t\t" << payload << "\t\t" << estimate.tau << "\t" << estimate.p
+              << "\t" << std::setw(5) << estimate.throughputMbps << "\t\t" << std::setw(5)
+              << estimate.perFlowMbps << "\t\t" << std::setw(5) << estimate.serviceTimeMs
+              << "\t\t";
+    if (estimate.saturated)
+    {
+        std::cout << std::setw(5) << estimate.delayMs << "\n";
+    }
+    else
+    {
+        std::cout << "n/a\n";
+    }
+    return estimate;
+}
+
+// Roda a simulação equivalente e compara o goodput por fluxo com a estimativa analítica. Os dois
+// lados contam só bytes de aplicação: o modelo usa payload * 8 e o resumo da execução desconta os
+// cabeçalhos IP e de transporte (BytesAplicacao).
+void
+ValidarEstimativaDcf(std::int16_t scenario, const EstimativaDcf& estimate)
+{
+    ExecutarCenario(scenario);
+
+    double simulated = lastRun.flows ? lastRun.goodputMbps / lastRun.flows : 0;
+    std::cout << "\t\t\t|================= Validação da estimativa =================|\n";
+    std::cout << "Goodput por fluxo: analítico " << estimate.perFlowMbps << " Mbps, simulado "
+              << simulated << " Mbps, erro relativo "
+              << (simulated > 0 ? 100 * (estimate.perFlowMbps - simulated) / simulated : 0)
+              << "%\n";
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::int16_t scenario = 1;
+    uint32_t seed = 0;      // 0 = semente derivada do relógio
+    uint64_t runNumber = 0; // 0 = número de execução aleatório
+
+    CommandLine cmd;
+    cmd.AddValue("scenario",
+                 "Cenário (0=TCP, 1=UDP, 2=TCP móvel, 3=UDP móvel, 4=UDP/TCP, 5=UDP/TCP móvel)",
+                 scenario);
+    cmd.AddValue("nClients", "Número de clientes na rede sem fio", nClients);
+    cmd.AddValue("tcpVariant",
+                 "Controle de congestionamento TCP (NewReno, Cubic, Bbr, Vegas, Westwood)",
+                 tcpVariant);
+    cmd.AddValue("tcpInitialCwnd", "Janela de congestionamento inicial (segmentos)", tcpInitialCwnd);
+    cmd.AddValue("tcpSegmentSize", "Tamanho do segmento TCP (bytes)", tcpSegmentSize);
+    cmd.AddValue("tcpSndBufSize", "Buffer de envio do socket TCP (bytes)", tcpSndBufSize);
+    cmd.AddValue("tcpRcvBufSize", "Buffer de recepção do socket TCP (bytes)", tcpRcvBufSize);
+    cmd.AddValue("queueDisc",
+                 "Fila no AP e no P2P (Default, None, PfifoFast, FqCoDel, CoDel, Pie, FqCobalt, Red)",
+                 queueDisc);
+    cmd.AddValue("wifiMacQueueSize", "Capacidade da fila MAC do Wi-Fi (ex.: 500p)", wifiMacQueueSize);
+    cmd.AddValue("p2pDataRate", "Taxa do enlace servidor <-> AP", p2pDataRate);
+    cmd.AddValue("p2pDelay", "Atraso de propagação do enlace servidor <-> AP", p2pDelay);
+    cmd.AddValue("p2pJitter", "Variação máxima de atraso do enlace P2P", p2pJitter);
+    cmd.AddValue("p2pErrorModel", "Modelo de perdas no P2P (Rate ou Burst)", p2pErrorModel);
+    cmd.AddValue("p2pErrorRate", "Taxa de perda (Rate) ou de início de rajada (Burst)", p2pErrorRate);
+    cmd.AddValue("p2pBurstSize", "Tamanho máximo da rajada de perdas (pacotes)", p2pBurstSize);
+    cmd.AddValue("trafficMix",
+                 "Mistura de tráfego em % (ex.: Cbr:50,Voip:25,Http:25; modelos: Cbr, Bulk, "
+                 "Poisson, Voip, Video, Http)",
+                 trafficMix);
+    cmd.AddValue("trafficDataRate", "Taxa dos geradores Cbr/Poisson", trafficDataRate);
+    cmd.AddValue("trafficPacketSize", "Tamanho do pacote dos geradores (bytes)", trafficPacketSize);
+    cmd.AddValue("trafficDirection",
+                 "Sentido do tráfego (Uplink, Downlink, Bidirectional)",
+                 trafficDirection);
+    cmd.AddValue("startDistribution",
+                 "Distribuição do início dos clientes (Fixed, Uniform, Poisson, Ramp)",
+                 startDistribution);
+    cmd.AddValue("startSpread",
+                 "Janela em que a associação e os geradores dos clientes são espalhados (s)",
+                 startSpread);
+    cmd.AddValue("churnArrivalRate",
+                 "Chegadas de estações por segundo no modo de rotatividade (0 = desligado)",
+                 churnArrivalRate);
+    cmd.AddValue("churnSessionMean",
+                 "Duração média da sessão de uma estação (s)",
+                 churnSessionMean);
+    cmd.AddValue("churnPool",
+                 "Clientes reservados para a rotatividade, com rádio desligado fora das sessões",
+                 churnPool);
+    cmd.AddValue("qos", "Habilita QoS (EDCA 802.11e) nas MACs e a marcação TOS dos fluxos", qos);
+    cmd.AddValue("qosMarking",
+                 "Marcação por classe: Modelo/Transporte, Modelo ou Transporte -> VO, VI, BE, BK "
+                 "ou byte TOS",
+                 qosMarking);
+    cmd.AddValue("qosEdca",
+                 "Parâmetros EDCA por AC: \"VO:CWmin,CWmax,AIFSN,TXOP(us);...\" (vazio = padrão)",
+                 qosEdca);
+    cmd.AddValue("clientTopology",
+                 "Posição dos clientes ao redor do AP (Grid, Ring, Opposite)",
+                 clientTopology);
+    cmd.AddValue("topologyRadius",
+                 "Distância dos clientes ao AP nas topologias Ring e Opposite (m)",
+                 topologyRadius);
+    cmd.AddValue("rtsThreshold",
+                 "Quadros maiores que este valor usam RTS/CTS (bytes, 65535 = sem proteção)",
+                 rtsThreshold);
+    cmd.AddValue("fragmentationThreshold",
+                 "Quadros maiores que este valor são fragmentados (bytes)",
+                 fragmentationThreshold);
+    cmd.AddValue("collisionStats",
+                 "Conta transmissões de dados sem ACK e RTS sem CTS",
+                 collisionStats);
+    cmd.AddValue("rtsCompare",
+                 "Executa o cenário sem e com RTS/CTS e compara colisões e vazão",
+                 rtsCompare);
+    cmd.AddValue("capacitySearch",
+                 "Busca o maior número de clientes que atende ao SLA",
+                 capacitySearch);
+    cmd.AddValue("searchMaxClients", "Limite superior da busca de capacidade", searchMaxClients);
+    cmd.AddValue("loadSweep",
+                 "Varre tamanho de pacote x carga por cliente e mede eficiência MAC e saturação",
+                 loadSweep);
+    cmd.AddValue("sweepPacketSizes",
+                 "Tamanhos de pacote da varredura, separados por vírgula (bytes)",
+                 sweepPacketSizes);
+    cmd.AddValue("sweepLoads",
+                 "Cargas por cliente da varredura, separadas por vírgula (Mbps)",
+                 sweepLoads);
+    cmd.AddValue("slaMaxLoss", "SLA: perda agregada máxima (%)", slaMaxLoss);
+    cmd.AddValue("slaMaxP99Delay", "SLA: percentil 99 máximo do atraso (ms)", slaMaxP99Delay);
+    cmd.AddValue("slaMinGoodput",
+                 "SLA: goodput mínimo de cada fluxo (% da carga oferecida)",
+                 slaMinGoodput);
+    cmd.AddValue("analytic",
+                 "Estima a capacidade pelo modelo de Bianchi, sem simular",
+                 analytic);
+    cmd.AddValue("analyticValidate",
+                 "Roda também a simulação equivalente para validar a estimativa",
+                 analyticValidate);
+    cmd.AddValue("dcfDataRate", "Taxa PHY dos dados no modelo analítico (Mbps)", dcfDataRate);
+    cmd.AddValue("dcfControlRate", "Taxa PHY dos ACKs no modelo analítico (Mbps)", dcfControlRate);
+    cmd.AddValue("seed", "Semente do gerador aleatório (0 = relógio)", seed);
+    cmd.AddValue("runNumber", "Número da execução (0 = aleatório)", runNumber);
+    cmd.AddValue("resultCache",
+                 "Reaproveita o resumo de execuções com configuração idêntica",
+                 resultCache);
+    cmd.AddValue("cacheDir", "Diretório do cache de resultados", cacheDir);
+    cmd.AddValue("outputDir", "Diretório base das saídas de cada execução", outputDir);
+    cmd.AddValue("resultsDb",
+                 "Banco SQLite onde gravar os resultados por execução e por fluxo",
+                 resultsDb);
+    cmd.AddValue("flowSampling",
+                 "Amostragem 1-em-N do monitor de fluxos, sem sondas por nó (1 = FlowMonitor "
+                 "completo)",
+                 flowSampling);
+    cmd.AddValue("latencySampling",
+                 "Decompõe o atraso por salto em 1 de cada N pacotes (0 = desligado)",
+                 latencySampling);
+    cmd.AddValue("dropCauses",
+                 "Contabiliza a causa de cada descarte (PHY/MAC Wi-Fi, filas, P2P, IPv4, RTO)",
+                 dropCauses);
+    cmd.AddValue("telemetryInterval",
+                 "Intervalo da série de ocupação da fila e do canal no AP (s, 0 = desligada)",
+                 telemetryInterval);
+    cmd.AddValue("tcpTraceInterval",
+                 "Intervalo da amostragem binária de cwnd, RTT, RTO, ssthresh e estado do TCP "
+                 "em tcp-internos.bin (s, 0 = desligada; ver tcp-analyzer)",
+                 tcpTraceInterval);
+    cmd.AddValue("heatmapInterval",
+                 "Intervalo das amostras de posição, vazão, SNR e taxa PHY dos clientes para o mapa "
+                 "de calor (s, 0 = desligado)",
+                 heatmapInterval);
+    cmd.AddValue("heatmapCell", "Lado da célula do mapa de calor (m)", heatmapCell);
+    cmd.AddValue("delayLog",
+                 "Registra envio e entrega de cada pacote em atrasos.bin (ver delay-analyzer)",
+                 delayLog);
+    cmd.Parse(argc, argv);
+
+    if (scenario < 0 || scenario > 5)
+    {
+        NS_FATAL_ERROR("Cenário inválido: " << scenario << " (esperado de 0 a 5)");
+    }
+#ifndef HAVE_SQLITE3
+    // Falha antes de simular: sem SQLite o banco só seria gravado depois da primeira execução
+    if (!resultsDb.empty())
+    {
+        NS_FATAL_ERROR("resultsDb exige o ns-3 compilado com suporte a SQLite");
+    }
+#endif
+
+    if (resultCache && (seed == 0 || runNumber == 0))
+    {
+        NS_LOG_UNCOND("Cache: sem seed/runNumber fixos cada execução terá uma chave nova");
+    }
+
+    RngSeedManager::SetSeed(seed ? seed : time(0));
+    RngSeedManager::SetRun(runNumber ? runNumber : rand());
+
+    ConfigurarTcp();
+    Config::SetDefault("ns3::WifiMacQueue::MaxSize", QueueSizeValue(QueueSize(wifiMacQueueSize)));
+    Config::SetDefault("ns3::WifiMac::QosSupported", BooleanValue(qos));
+    AplicarLimiaresWifi();
+
+    if (analytic)
+    {
+        EstimativaDcf estimate = ImprimirEstimativaDcf(scenario);
+        if (analyticValidate)
+        {
+            ValidarEstimativaDcf(scenario, estimate);
+        }
+    }
+    else if (capacitySearch)
+    {
+        BuscarCapacidade(scenario);
+    }
+    else if (loadSweep)
+    {
+        VarrerCarga(scenario);
+    }
+    else if (rtsCompare)
+    {
+        CompararRtsCts(scenario);
+    }
+    else
+    {
+        ExecutarCenario(scenario);
+    }
+
+    if (resultCache)
+    {
+        std::cout << "Cache de resultados: " << cacheHits << " acertos, " << cacheMisses
+                  << " faltas\n";
+    }
+
+#ifdef HAVE_SQLITE3
+    FecharBanco();
+#endif
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,238 @@
+// Decodificação dos internos do TCP (tcp-internos.bin, gerado com --tcpTraceInterval=T).
+//
+// O arquivo começa com "TCPINT01", o tamanho do registro (uint32, 36) e 4 bytes reservados. Cada
+// registro, sem alinhamento e em ordem de tempo, traz o estado de um socket que mudou no
+// intervalo: instante (double), índice do socket, cwnd e ssthresh em bytes, retransmissões
+// acumuladas (uint32), RTT e RTO em ms (float), estado de congestionamento e 3 bytes de
+// preenchimento. Entre dois registros do mesmo socket os valores são os do registro anterior,
+// então a cwnd média é ponderada pelo tempo até o último registro do arquivo.
+//
+// Uso: tcp-analyzer [--sockets=tcp-internos-sockets.csv] [--csv=registros.csv] tcp-internos.bin
+//
+// Com --sockets, o resumo mostra os endereços de cada socket; com --csv, todos os registros são
+// exportados em texto.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+// Mesmo layout do RegistroTcp do script_Equipe_2.cc
+#pragma pack(push, 1)
+struct RegistroTcp
+{
+    double time;
+    uint32_t socket;
+    uint32_t cwnd;
+    uint32_t ssthresh;
+    uint32_t retransmissions;
+    float rttMs;
+    float rtoMs;
+    uint8_t congState;
+    uint8_t padding[3];
+};
+#pragma pack(pop)
+static_assert(sizeof(RegistroTcp) == 36, "tcp-internos.bin usa registros de 36 bytes");
+
+// Nomes de TcpSocketState::TcpCongState_t
+const char* const estados[] = {"OPEN", "DISORDER", "CWR", "RECOVERY", "LOSS"};
+
+// Resumo de um socket ao longo dos registros
+struct ResumoSocket
+{
+    uint64_t records = 0;
+    double first = 0;
+    double last = 0;
+    uint32_t cwnd = 0;
+    double cwndArea = 0;
+    uint32_t cwndMax = 0;
+    double rttSumMs = 0;
+    uint64_t rttSamples = 0;
+    float rtoMaxMs = 0;
+    uint32_t retransmissions = 0;
+    uint8_t state = 0;
+    uint32_t entries[5] = {}; // Entradas em cada estado de congestionamento
+};
+
+// Lê tcp-internos.bin por mmap
+bool
+CarregarRegistros(const std::string& path, std::vector<RegistroTcp>& records)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0 || info.st_size < 16)
+    {
+        std::cerr << "Não foi possível abrir " << path << "\n";
+        return false;
+    }
+    std::size_t length = info.st_size;
+    void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        std::cerr << "Falha no mmap de " << path << "\n";
+        return false;
+    }
+    const uint8_t* data = static_cast<const uint8_t*>(mapping);
+
+    uint32_t recordSize;
+    std::memcpy(&recordSize, data + 8, 4);
+    if (std::memcmp(data, "TCPINT01", 8) != 0 || recordSize != sizeof(RegistroTcp))
+    {
+        std::cerr << path << " não é um registro de internos do TCP reconhecido\n";
+        munmap(mapping, length);
+        return false;
+    }
+
+    std::size_t n = (length - 16) / sizeof(RegistroTcp);
+    records.resize(n);
+    std::memcpy(records.data(), data + 16, n * sizeof(RegistroTcp));
+    munmap(mapping, length);
+    return true;
+}
+
+// Lê tcp-internos-sockets.csv: socket -> "local -> par"
+bool
+LerTabelaSockets(const std::string& path, std::map<uint32_t, std::string>& labels)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << "Não foi possível abrir " << path << "\n";
+        return false;
+    }
+    std::string line;
+    std::getline(file, line); // Cabeçalho
+    while (std::getline(file, line))
+    {
+        std::istringstream fields(line);
+        std::string socket;
+        std::string node;
+        std::string local;
+        std::string peer;
+        std::getline(fields, socket, ',');
+        std::getline(fields, node, ',');
+        std::getline(fields, local, ',');
+        std::getline(fields, peer, ',');
+        labels[std::stoul(socket)] = "nó " + node + " " + local + " -> " + peer;
+    }
+    return true;
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::string socketsPath;
+    std::string csvPath;
+    std::string input;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument.rfind("--sockets=", 0) == 0)
+        {
+            socketsPath = argument.substr(10);
+        }
+        else if (argument.rfind("--csv=", 0) == 0)
+        {
+            csvPath = argument.substr(6);
+        }
+        else
+        {
+            input = argument;
+        }
+    }
+    if (input.empty())
+    {
+        std::cerr << "Uso: " << argv[0]
+                  << " [--sockets=tcp-internos-sockets.csv] [--csv=registros.csv] "
+                     "tcp-internos.bin\n";
+        return 1;
+    }
+
+    std::vector<RegistroTcp> records;
+    if (!CarregarRegistros(input, records))
+    {
+        return 1;
+    }
+    std::map<uint32_t, std::string> labels;
+    if (!socketsPath.empty() && !LerTabelaSockets(socketsPath, labels))
+    {
+        return 1;
+    }
+
+    std::ofstream csv;
+    if (!csvPath.empty())
+    {
+        csv.open(csvPath);
+        csv << "time,socket,cwnd,ssthresh,retransmissions,rttMs,rtoMs,congState\n";
+    }
+
+    std::map<uint32_t, ResumoSocket> sockets;
+    double end = 0;
+    for (const RegistroTcp& record : records)
+    {
+        uint8_t state = std::min<uint8_t>(record.congState, 4);
+        if (csv.is_open())
+        {
+            csv << record.time << "," << record.socket << "," << record.cwnd << ","
+                << record.ssthresh << "," << record.retransmissions << "," << record.rttMs << ","
+                << record.rtoMs << "," << estados[state] << "\n";
+        }
+
+        ResumoSocket& summary = sockets[record.socket];
+        if (summary.records == 0)
+        {
+            summary.first = record.time;
+            summary.entries[state]++;
+        }
+        else
+        {
+            summary.cwndArea += double(summary.cwnd) * (record.time - summary.last);
+            summary.entries[state] += state != summary.state;
+        }
+        if (record.rttMs > 0)
+        {
+            summary.rttSumMs += record.rttMs;
+            summary.rttSamples++;
+        }
+        summary.records++;
+        summary.last = record.time;
+        summary.cwnd = record.cwnd;
+        summary.cwndMax = std::max(summary.cwndMax, uint32_t(record.cwnd));
+        summary.rtoMaxMs = std::max(summary.rtoMaxMs, float(record.rtoMs));
+        summary.retransmissions = record.retransmissions;
+        summary.state = state;
+        end = std::max(end, record.time);
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << records.size() << " registros de " << sockets.size() << " sockets até " << end
+              << " s\n";
+    std::cout << "Socket\tRegistros\tcwnd média (B)\tcwnd máx. (B)\tRTT médio (ms)\tRTO máx. (ms)\t"
+                 "Retrans.\tRecuperações\tTimeouts\tEndereços\n";
+    for (const auto& item : sockets)
+    {
+        const ResumoSocket& summary = item.second;
+        double area = summary.cwndArea + double(summary.cwnd) * (end - summary.last);
+        double cwndMean = end > summary.first ? area / (end - summary.first) : summary.cwnd;
+        double rttMean = summary.rttSamples ? summary.rttSumMs / summary.rttSamples : 0;
+        auto label = labels.find(item.first);
+        std::cout << item.first << "\t" << summary.records << "\t\t" << cwndMean << "\t"
+                  << summary.cwndMax << "\t\t" << rttMean << "\t\t" << summary.rtoMaxMs << "\t\t"
+                  << summary.retransmissions << "\t\t" << summary.entries[3] << "\t\t"
+                  << summary.entries[4] << "\t\t"
+                  << (label == labels.end() ? "" : label->second) << "\n";
+    }
+    return 0;
+}